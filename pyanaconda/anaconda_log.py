@@ -24,10 +24,20 @@
 
 import logging
 from logging.handlers import SysLogHandler, SYSLOG_UDP_PORT
+import atexit
+import copy
+import errno
+import fcntl
 import os
+import select
+import struct
 import sys
+import threading
+import time
 import types
 import warnings
+import zlib
+from collections import defaultdict, deque
 
 from pyanaconda.flags import flags
 
@@ -46,6 +56,28 @@ PACKAGING_LOG_FILE = "/tmp/packaging.log"
 SENSITIVE_INFO_LOG_FILE = "/tmp/sensitive-info.log"
 ANACONDA_SYSLOG_FACILITY = SysLogHandler.LOG_LOCAL1
 
+# Number of log records that may wait to be written.  When there are more,
+# new records are dropped and counted rather than blocking the caller.
+ASYNC_QUEUE_SIZE = 20000
+# Number of records written between flushes of the log files
+ASYNC_BATCH_SIZE = 256
+# Seconds to wait for the queued records to be written at exit and when a
+# handler is flushed, so a stalled syslog or tty cannot hang anaconda
+ASYNC_FLUSH_TIMEOUT = 5
+
+# Framed log forwarding over the virtio port, see VirtioLogForwarder.  A
+# frame is a FRAME_HEADER (magic, version, flags, reserved, sequence number,
+# number of records, number of records dropped since the previous frame,
+# payload length) followed by the payload, which is zlib compressed if
+# FRAME_FLAG_ZLIB is set.  The payload is a series of FRAME_RECORDs (time,
+# level, length of the logger name, length of the message) each followed
+# by the logger name and the message in UTF-8.  scripts/analog decodes it.
+FRAME_MAGIC = "ALOG"
+FRAME_VERSION = 1
+FRAME_FLAG_ZLIB = 1
+FRAME_HEADER = struct.Struct("!4sBBHIIII")
+FRAME_RECORD = struct.Struct("!dBBI")
+
 from threading import Lock
 program_log_lock = Lock()
 
@@ -76,6 +108,298 @@ class AnacondaSyslogHandler(SysLogHandler):
         SysLogHandler.emit(self, record)
         record.msg = original_msg
 
+class AsyncLogWriter(object):
+    """Writes the records queued by AsyncHandlers to their target handlers
+       from a background thread, so that logging never waits for a file,
+       a tty or the syslog socket.
+
+       Records are written in batches and the files are flushed once per
+       batch.  If the queue is full, records are dropped and a warning
+       with the number of dropped records is written to the handler they
+       were meant for as soon as there is room again.
+
+       A process forked from anaconda has no writer thread, and the lock of
+       the queue may have been held by it at the time of the fork.  Such a
+       process writes its records itself, right away.
+    """
+    def __init__(self, name, size=ASYNC_QUEUE_SIZE):
+        self._name = name
+        self._pid = os.getpid()
+        self._forked_handlers = set()
+        self._size = size
+        self._records = deque()
+        self._dropped = defaultdict(int)
+        self._cond = threading.Condition(threading.Lock())
+        self._busy = False
+        self._thread = None
+
+    def _put_forked(self, handler, record):
+        # The handler's lock is as suspect as ours, give it a new one.
+        if handler not in self._forked_handlers:
+            handler.createLock()
+            self._forked_handlers.add(handler)
+        self._write([(handler, record)], {})
+
+    def put(self, handler, record):
+        if os.getpid() != self._pid:
+            self._put_forked(handler, record)
+            return
+
+        with self._cond:
+            if len(self._records) >= self._size:
+                self._dropped[handler] += 1
+                return
+
+            self._records.append((handler, record))
+            if self._thread is None:
+                # Not an AnacondaThread, this one never exits and must not
+                # be waited for by threadMgr.
+                self._thread = threading.Thread(name=self._name, target=self._run)
+                self._thread.daemon = True
+                self._thread.start()
+            self._cond.notify()
+
+    def flush(self, timeout=None):
+        """Wait until everything queued so far is written, or until the
+           timeout (in seconds) passes.
+        """
+        # the writer cannot wait for itself, a handler may log an error
+        if self._thread is None or threading.current_thread() is self._thread or \
+           os.getpid() != self._pid:
+            return
+
+        deadline = time.time() + timeout if timeout is not None else None
+        with self._cond:
+            while self._records or self._busy or self._dropped:
+                if deadline is None:
+                    self._cond.wait()
+                else:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        break
+                    self._cond.wait(remaining)
+
+    def _run(self):
+        while True:
+            with self._cond:
+                while not self._records and not self._dropped:
+                    self._busy = False
+                    self._cond.notify_all()
+                    self._cond.wait()
+
+                self._busy = True
+                count = min(len(self._records), ASYNC_BATCH_SIZE)
+                batch = [self._records.popleft() for _i in range(count)]
+                dropped = self._dropped
+                self._dropped = defaultdict(int)
+
+            self._write(batch, dropped)
+
+    def _write(self, batch, dropped):
+        used = set()
+
+        for handler, count in dropped.items():
+            record = logging.LogRecord("anaconda", logging.WARNING, __file__, 0,
+                                       "%d log messages were dropped, the log queue was full",
+                                       (count,), None)
+            batch.insert(0, (handler, record))
+
+        for handler, record in batch:
+            used.add(handler)
+            if not handler.filter(record):
+                continue
+
+            handler.acquire()
+            try:
+                # StreamHandler.emit flushes after every record, do it once
+                # per batch instead
+                if isinstance(handler, logging.StreamHandler) and handler.stream:
+                    msg = handler.format(record)
+                    if isinstance(msg, unicode):
+                        msg = msg.encode("utf-8")
+                    handler.stream.write(msg + "\n")
+                else:
+                    handler.emit(record)
+            except Exception: # pylint: disable-msg=W0703
+                handler.handleError(record)
+            finally:
+                handler.release()
+
+        for handler in used:
+            try:
+                handler.flush()
+            except (IOError, OSError):
+                # nothing to report it to, the records will be missing
+                pass
+
+class AsyncHandler(logging.Handler):
+    """A handler that passes records on to its target handler through an
+       AsyncLogWriter.  The level of this handler is the one that counts,
+       the formatter is the target's.
+    """
+    def __init__(self, target, writer):
+        logging.Handler.__init__(self, target.level)
+        target.setLevel(logging.NOTSET)
+        self.target = target
+        self._writer = writer
+
+    def setFormatter(self, fmt):
+        self.target.setFormatter(fmt)
+
+    def emit(self, record):
+        # The record is written later, make it independent of the objects
+        # passed by the caller, which may change in the meantime.
+        try:
+            record = copy.copy(record)
+            record.msg = record.getMessage()
+            record.args = None
+            if record.exc_info:
+                record.exc_text = logging.Formatter().formatException(record.exc_info)
+                record.exc_info = None
+        except Exception: # pylint: disable-msg=W0703
+            self.handleError(record)
+            return
+
+        self._writer.put(self.target, record)
+
+    def flush(self):
+        self._writer.flush(ASYNC_FLUSH_TIMEOUT)
+
+    def close(self):
+        self.target.close()
+        logging.Handler.close(self)
+
+class VirtioLogForwarder(logging.Handler):
+    """Sends log records over the virtio port in batches.
+
+       This is meant to be the target of AsyncHandlers: emit() only encodes
+       the record and flush(), which the AsyncLogWriter calls after every
+       batch, sends everything encoded so far as one frame.
+
+       The port is written without blocking for more than WRITE_TIMEOUT per
+       batch.  If the host does not read fast enough, frames are kept until
+       there are MAX_BUFFERED bytes of them, then the oldest ones that were
+       not started yet are dropped.  The number of dropped records is sent
+       in the next frame.
+
+       A process forked from anaconda shares the port with it and inherits
+       the frames it has not sent yet, one of them maybe partly sent.  Its
+       frames would end up in the middle of anaconda's, so such a process
+       does not forward anything; its records still go to the log files.
+    """
+    MAX_BUFFERED = 1024 * 1024
+    WRITE_TIMEOUT = 1.0
+    CLOSE_TIMEOUT = 5.0
+    # smaller payloads do not compress well enough to be worth it
+    COMPRESS_MIN = 512
+
+    def __init__(self, path, compress=False):
+        # open the port first, a handler that fails to initialize must not
+        # end up in the list logging.shutdown() goes through
+        self._pid = os.getpid()
+        self._fd = os.open(path, os.O_WRONLY | os.O_NONBLOCK)
+        fcntl.fcntl(self._fd, fcntl.F_SETFD, fcntl.fcntl(self._fd, fcntl.F_GETFD) | fcntl.FD_CLOEXEC)
+        logging.Handler.__init__(self)
+        self._compress = compress
+        self._pending = []
+        self._frames = deque()
+        self._offset = 0
+        self._buffered = 0
+        self._sequence = 0
+        self._unreported = 0
+        self.dropped = 0
+
+    def emit(self, record):
+        if os.getpid() != self._pid:
+            return
+
+        name = record.name[:255]
+        msg = self.format(record)
+        if isinstance(name, unicode):
+            name = name.encode("utf-8")
+        if isinstance(msg, unicode):
+            msg = msg.encode("utf-8")
+
+        self._pending.append(FRAME_RECORD.pack(record.created, record.levelno, len(name), len(msg)) +
+                             name + msg)
+
+    def flush(self):
+        if os.getpid() != self._pid:
+            return
+
+        self.acquire()
+        try:
+            if self._pending:
+                self._frame()
+            self._send(self.WRITE_TIMEOUT)
+        finally:
+            self.release()
+
+    def close(self):
+        self.acquire()
+        try:
+            if self._fd is not None:
+                if os.getpid() == self._pid:
+                    if self._pending:
+                        self._frame()
+                    self._send(self.CLOSE_TIMEOUT)
+                os.close(self._fd)
+                self._fd = None
+        finally:
+            self.release()
+        logging.Handler.close(self)
+
+    def _frame(self):
+        payload = "".join(self._pending)
+        flags = 0
+        if self._compress and len(payload) >= self.COMPRESS_MIN:
+            payload = zlib.compress(payload, 1)
+            flags |= FRAME_FLAG_ZLIB
+
+        frame = FRAME_HEADER.pack(FRAME_MAGIC, FRAME_VERSION, flags, 0, self._sequence,
+                                  len(self._pending), self._unreported, len(payload)) + payload
+        self._frames.append((frame, len(self._pending)))
+        self._buffered += len(frame)
+        self._sequence = (self._sequence + 1) & 0xffffffff
+        self._unreported = 0
+        self._pending = []
+
+        # the first frame may be partially sent already, it has to stay
+        while self._buffered > self.MAX_BUFFERED and len(self._frames) > 1:
+            frame, count = self._frames[1]
+            del self._frames[1]
+            self._buffered -= len(frame)
+            self._unreported += count
+            self.dropped += count
+
+    def _send(self, timeout):
+        deadline = time.time() + timeout
+        while self._frames and self._fd is not None:
+            frame = self._frames[0][0]
+            try:
+                self._offset += os.write(self._fd, frame[self._offset:])
+            except OSError as e:
+                if e.errno not in (errno.EAGAIN, errno.EINTR):
+                    # the port is broken, there is no point in keeping anything
+                    for _frame, count in self._frames:
+                        self._unreported += count
+                        self.dropped += count
+                    self._frames.clear()
+                    self._buffered = 0
+                    self._offset = 0
+                    return
+
+                remaining = deadline - time.time()
+                if remaining <= 0:
+                    return
+                select.select([], [self._fd], [], remaining)
+                continue
+
+            if self._offset == len(frame):
+                self._frames.popleft()
+                self._buffered -= len(frame)
+                self._offset = 0
+
 class AnacondaLog:
     SYSLOG_CFGFILE  = "/etc/rsyslog.conf"
     VIRTIO_PORT = "/dev/virtio-ports/org.fedoraproject.anaconda.log.0"
@@ -83,6 +407,14 @@ class AnacondaLog:
     def __init__ (self):
         self.tty_loglevel = DEFAULT_TTY_LEVEL
         self.remote_syslog = None
+        # Everything except stdout and stderr is written from a thread.
+        # syslog, the ttys and the virtio port stall when nobody reads them,
+        # so they get a thread of their own and cannot hold up the files.
+        self.writer = AsyncLogWriter("AnaLogWriterThread")
+        self.device_writer = AsyncLogWriter("AnaDeviceLogWriterThread")
+        atexit.register(self.flush, ASYNC_FLUSH_TIMEOUT)
+        self.virtio_forwarder = None
+        self._forwarded_loggers = []
         # Rename the loglevels so they are the same as in syslog.
         logging.addLevelName(logging.WARNING, "WARN")
         logging.addLevelName(logging.ERROR, "ERR")
@@ -161,12 +493,15 @@ class AnacondaLog:
                             fmtStr=STDOUT_FORMAT, minLevel=logging.INFO)
 
     # Add a simple handler - file or stream, depending on what we're given.
+    # Files are written asynchronously, streams are not so that their output
+    # stays in order with whatever else is printed to them.
     def addFileHandler (self, dest, addToLogger, minLevel=DEFAULT_TTY_LEVEL,
                         fmtStr=ENTRY_FORMAT,
                         autoLevel=False):
         try:
             if isinstance(dest, types.StringTypes):
-                logfileHandler = logging.FileHandler(dest)
+                writer = self.device_writer if dest.startswith("/dev/") else self.writer
+                logfileHandler = AsyncHandler(logging.FileHandler(dest), writer)
             else:
                 logfileHandler = logging.StreamHandler(dest)
 
@@ -184,10 +519,14 @@ class AnacondaLog:
             # don't clutter up the system logs when doing an image install
             return
 
-        syslogHandler = AnacondaSyslogHandler(
-            '/dev/log',
-            ANACONDA_SYSLOG_FACILITY,
-            logr.name)
+        self._forwarded_loggers.append(logr)
+        if self.virtio_forwarder:
+            self._addVirtioForwarder(logr)
+
+        syslogHandler = AsyncHandler(AnacondaSyslogHandler('/dev/log',
+                                                           ANACONDA_SYSLOG_FACILITY,
+                                                           logr.name),
+                                     self.device_writer)
         syslogHandler.setLevel(logging.DEBUG)
         logr.addHandler(syslogHandler)
 
@@ -202,6 +541,17 @@ class AnacondaLog:
         self.anaconda_logger.warning("%s" % warnings.formatwarning(
                 message, category, filename, lineno, line))
 
+    def flush(self, timeout=None):
+        """Wait until all of the log messages are written out, or until
+           the timeout (in seconds) passes.
+        """
+        deadline = time.time() + timeout if timeout is not None else None
+        for writer in (self.writer, self.device_writer):
+            if deadline is None:
+                writer.flush()
+            else:
+                writer.flush(max(0, deadline - time.time()))
+
     def restartSyslog(self):
         os.system("systemctl restart rsyslog.service")
 
@@ -218,8 +568,19 @@ class AnacondaLog:
             cfgfile.write(forward_line)
         self.restartSyslog()
 
-    def setupVirtio(self):
-        """Setup virtio rsyslog logging.
+    def _addVirtioForwarder(self, logr):
+        handler = AsyncHandler(self.virtio_forwarder, self.device_writer)
+        handler.setLevel(logging.DEBUG)
+        logr.addHandler(handler)
+
+    def setupVirtio(self, mode=None):
+        """Setup virtio logging.
+
+           By default rsyslog forwards all of the syslog messages to the
+           virtio port, one line each.  With mode "framed" or "compressed",
+           the loggers that are forwarded to syslog send their records over
+           the port themselves, batched into frames that are zlib compressed
+           in the "compressed" mode.  Receive them with analog -f.
         """
         TEMPLATE = "*.* %s;anaconda_syslog\n"
 
@@ -227,6 +588,18 @@ class AnacondaLog:
            or not os.access(self.VIRTIO_PORT, os.W_OK):
             return
 
+        if mode in ("framed", "compressed"):
+            try:
+                self.virtio_forwarder = VirtioLogForwarder(self.VIRTIO_PORT,
+                                                           compress=(mode == "compressed"))
+            except OSError as e:
+                self.anaconda_logger.error("Cannot open %s: %s", self.VIRTIO_PORT, e)
+                return
+
+            for logr in self._forwarded_loggers:
+                self._addVirtioForwarder(logr)
+            return
+
         with open(self.SYSLOG_CFGFILE, 'a') as cfgfile:
             cfgfile.write(TEMPLATE % (self.VIRTIO_PORT,))
         self.restartSyslog()
@@ -236,3 +609,8 @@ logger = None
 def init():
     global logger
     logger = AnacondaLog()
+
+def flush(timeout=None):
+    """Wait until all of the log messages are written out."""
+    if logger:
+        logger.flush(timeout)
@@ -111,6 +111,11 @@ THREAD_TIME_INIT = "AnaTimeInitThread"
 THREAD_XKL_WRAPPER_INIT = "AnaXklWrapperInitThread"
 THREAD_KEYBOARD_INIT = "AnaKeyboardThread"
 THREAD_ADD_LAYOUTS_INIT = "AnaAddLayoutsInitThread"
+THREAD_PRELOAD_TRANSLATIONS = "AnaPreloadTranslationsThread"
+THREAD_PRELOAD_MODULES = "AnaPreloadModulesThread"
+THREAD_INITRD_BASENAME = "AnaInitrdThread"
+THREAD_INSTALL_PROGRESS = "AnaInstallProgressThread"
+THREAD_REPO_METADATA_BASENAME = "AnaRepoMetadataThread"
 
 # Geolocation constants
 
@@ -24,7 +24,7 @@
 from meh import Config
 from meh.handler import ExceptionHandler
 from meh.dump import ReverseExceptionDump
-from pyanaconda import isys, iutil, kickstart
+from pyanaconda import isys, iutil, kickstart, anaconda_log
 import sys
 import os
 import shutil
@@ -82,6 +82,9 @@ class AnacondaExceptionHandler(ExceptionHandler):
 
         log.debug("running handleException")
 
+        # the logs are attached to the report, write out what is queued
+        anaconda_log.flush(timeout=anaconda_log.ASYNC_FLUSH_TIMEOUT)
+
         ty = dump_info.exc_info.type
         value = dump_info.exc_info.value
 
@@ -215,7 +218,7 @@ def initExceptionHandling(anaconda):
     fileList = [ "/tmp/anaconda.log", "/tmp/packaging.log",
                  "/tmp/program.log", "/tmp/storage.log", "/tmp/ifcfg.log",
                  "/tmp/yum.log", ROOT_PATH + "/root/install.log",
-                 "/proc/cmdline" ]
+                 "/tmp/anaconda-trace.json", "/proc/cmdline" ]
 
     if os.path.exists("/tmp/syslog"):
         fileList.extend(["/tmp/syslog"])
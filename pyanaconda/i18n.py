@@ -22,10 +22,45 @@
 __all__ = ["_", "N_", "P_", "C_", "CN_", "CP_"]
 
 import gettext
+import os
 
-_ = lambda x: gettext.ldgettext("anaconda", x)
+# gettext.ldgettext() searches for the message catalog again on every call,
+# stat()ing a file for each candidate language.  Which catalog is used only
+# depends on the locale environment variables, so remember the answer for
+# every combination of them.  The parsed catalogs are cached by gettext.
+_LOCALE_ENVARS = ("LANGUAGE", "LC_ALL", "LC_MESSAGES", "LANG")
+_catalogs = {}
+
+def _get_catalog(domain="anaconda"):
+    localedir = gettext._localedirs.get(domain, None)
+    key = (domain, localedir) + tuple(os.environ.get(envar) for envar in _LOCALE_ENVARS)
+
+    catalog = _catalogs.get(key)
+    if catalog is None:
+        try:
+            catalog = gettext.translation(domain, localedir,
+                                          codeset=gettext._localecodesets.get(domain))
+        except IOError:
+            catalog = gettext.NullTranslations()
+
+        catalog = _catalogs.setdefault(key, catalog)
+
+    return catalog
+
+def preload_catalogs(languages, domain="anaconda"):
+    """Parse the message catalogs for the given languages now, so that
+       switching to one of them later does not have to.  This may be called
+       from any thread.
+    """
+    for lang in languages:
+        try:
+            gettext.translation(domain, gettext._localedirs.get(domain, None), languages=[lang])
+        except IOError:
+            pass
+
+_ = lambda x: _get_catalog().lgettext(x)
 N_ = lambda x: x
-P_ = lambda x, y, z: gettext.ldngettext("anaconda", x, y, z)
+P_ = lambda x, y, z: _get_catalog().lngettext(x, y, z)
 
 # This is equivalent to "pgettext" in GNU gettext. The pgettext functions
 # are not exported by Python, but all they really do is a stick a EOT
@@ -27,6 +27,7 @@ from pyanaconda.progress import progress_report, progressQ
 from pyanaconda.users import createLuserConf, getPassAlgo, Users
 from pyanaconda import flags
 from pyanaconda import timezone
+from pyanaconda import anaconda_log
 from pyanaconda.i18n import _
 from pyanaconda.threads import threadMgr
 import logging
@@ -97,6 +98,8 @@ def doConfiguration(storage, payload, ksdata, instClass):
             ksdata.realm.execute(storage, ksdata, instClass)
 
     with progress_report(_("Running post-installation scripts")):
+        # the logs are copied to the target by one of the scripts
+        anaconda_log.flush(anaconda_log.ASYNC_FLUSH_TIMEOUT)
         runPostScripts(ksdata.scripts)
 
     # Write the kickstart file to the installed system (or, copy the input
@@ -160,6 +163,8 @@ def doInstall(storage, payload, ksdata, instClass):
     packages = [p for p in packages if p not in instClass.ignoredPackages]
     payload.preInstall(packages=packages, groups=payload.languageGroups())
     payload.install()
+    # the payload moves the bar within this step with progressQ.send_fraction
+    progressQ.send_step()
 
     if flags.flags.livecdInstall:
         storage.write()
@@ -173,4 +173,18 @@ def total_memory():
         log.error("MemTotal: line not found in /proc/meminfo")
         raise RuntimeError("MemTotal: line not found in /proc/meminfo")
 
+def available_memory():
+    """Returns the memory available for starting new programs in kB, as
+       estimated by the kernel, or None if it cannot be found out.
+    """
+    try:
+        with open("/proc/meminfo", "r") as fobj:
+            for line in fobj:
+                if line.startswith("MemAvailable:"):
+                    return int(line.split()[1])
+    except (IOError, IndexError, ValueError):
+        pass
+
+    return None
+
 handleSegv = _isys.handleSegv
@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
 #include <stdio.h>
@@ -58,6 +59,11 @@
 #include <linux/major.h>
 #include <signal.h>
 #include <execinfo.h>
+#include <poll.h>
+#include <ctype.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/wait.h>
 
 #ifdef MAJOR_IN_MKDEV
 #include <sys/mkdev.h>
@@ -82,6 +88,8 @@ static PyObject * doisIsoImage(PyObject * s, PyObject * args);
 static PyObject * doSegvHandler(PyObject *s, PyObject *args);
 static PyObject * doGetAnacondaVersion(PyObject * s, PyObject * args);
 static PyObject * doSetSystemTime(PyObject *s, PyObject *args);
+static PyObject * doReadLines(PyObject *s, PyObject *args);
+static PyObject * doSpawn(PyObject *s, PyObject *args);
 
 static PyMethodDef isysModuleMethods[] = {
     { "isPseudoTTY", (PyCFunction) doisPseudoTTY, METH_VARARGS, NULL},
@@ -90,6 +98,8 @@ static PyMethodDef isysModuleMethods[] = {
     { "handleSegv", (PyCFunction) doSegvHandler, METH_VARARGS, NULL },
     { "getAnacondaVersion", (PyCFunction) doGetAnacondaVersion, METH_VARARGS, NULL },
     { "set_system_time", (PyCFunction) doSetSystemTime, METH_VARARGS, NULL},
+    { "read_lines", (PyCFunction) doReadLines, METH_VARARGS, NULL},
+    { "spawn", (PyCFunction) doSpawn, METH_VARARGS, NULL},
     { NULL, NULL, 0, NULL }
 } ;
 
@@ -171,5 +181,372 @@ static PyObject * doSetSystemTime(PyObject *s, PyObject  *args) {
     return Py_None;
 }
 
+#define READ_LINES_CHUNK (64 * 1024)
+#define READ_LINES_MAX   (1024 * 1024)
+
+/* Append the whitespace stripped lines in buf[0:len] to list and return the
+ * length of the incomplete line at the end of buf, which is moved to the
+ * start of buf.  Returns -1 on error.
+ */
+static Py_ssize_t split_lines(char *buf, Py_ssize_t len, PyObject *list) {
+    char *start = buf, *end = buf + len, *nl, *first, *last;
+    PyObject *line;
+
+    while ((nl = memchr(start, '\n', end - start)) != NULL) {
+        /* same as str.strip() */
+        first = start;
+        last = nl;
+        while (first < last && isspace((unsigned char) *first))
+            first++;
+        while (last > first && isspace((unsigned char) last[-1]))
+            last--;
+
+        line = PyString_FromStringAndSize(first, last - first);
+        if (!line || PyList_Append(list, line) < 0) {
+            Py_XDECREF(line);
+            return -1;
+        }
+        Py_DECREF(line);
+
+        start = nl + 1;
+    }
+
+    memmove(buf, start, end - start);
+    return end - start;
+}
+
+/* read_lines(fd, partial, timeout) -> (lines, partial, eof)
+ *
+ * Wait up to timeout milliseconds for fd to become readable, read as much
+ * as is available in large chunks and return the complete lines, stripped
+ * of whitespace.  partial is the incomplete line returned by the previous
+ * call.  eof is True once the other end of fd is closed.
+ */
+static PyObject * doReadLines(PyObject *s, PyObject *args) {
+    int fd, timeout, rc, err = 0, eof = 0;
+    const char *partial;
+    Py_ssize_t partial_len, len, size;
+    struct pollfd pfd;
+    ssize_t n;
+    char *buf, *tmp;
+    PyObject *lines, *ret;
+
+    if (!PyArg_ParseTuple(args, "is#i", &fd, &partial, &partial_len, &timeout))
+        return NULL;
+
+    size = partial_len + READ_LINES_CHUNK;
+    buf = malloc(size);
+    if (!buf)
+        return PyErr_NoMemory();
+
+    memcpy(buf, partial, partial_len);
+    len = partial_len;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = poll(&pfd, 1, timeout);
+    while (rc > 0) {
+        n = read(fd, buf + len, size - len);
+        if (n < 0) {
+            if (errno != EINTR && errno != EAGAIN)
+                err = errno;
+            break;
+        } else if (n == 0) {
+            eof = 1;
+            break;
+        }
+        len += n;
+
+        /* a short read means the pipe is empty, no need to ask poll */
+        if (len < size)
+            break;
+
+        if (size - partial_len >= READ_LINES_MAX)
+            break;
+
+        tmp = realloc(buf, size * 2);
+        if (!tmp)
+            break;
+        buf = tmp;
+        size *= 2;
+
+        rc = poll(&pfd, 1, 0);
+    }
+    if (rc < 0 && errno != EINTR)
+        err = errno;
+    Py_END_ALLOW_THREADS
+
+    if (err) {
+        free(buf);
+        errno = err;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    lines = PyList_New(0);
+    if (!lines || (len = split_lines(buf, len, lines)) < 0) {
+        free(buf);
+        Py_XDECREF(lines);
+        return NULL;
+    }
+
+    ret = Py_BuildValue("(Ns#O)", lines, buf, len, eof ? Py_True : Py_False);
+    free(buf);
+    return ret;
+}
+
+#define SPAWN_STACK_SIZE (64 * 1024)
+
+struct spawn_args {
+    char **candidates;      /* paths to try executing, in order */
+    char **argv;
+    char **envp;
+    const char *root;
+    int stdin_fd;           /* -1 to inherit stdin */
+    int out_fd;             /* write end of the output pipe, >= 3 */
+    sigset_t *sigmask;      /* signal mask to restore before exec */
+    int err;                /* set by the child if it fails */
+};
+
+/* Runs in the child, which shares the memory of the parent until it execs
+ * or exits, so it must only make system calls and write to args->err.
+ */
+static int spawn_child(void *data) {
+    struct spawn_args *args = data;
+    struct sigaction sa, old;
+    int sig, i, err = ENOENT;
+
+    /* Python's signal handlers must not run on our memory. */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_DFL;
+    for (sig = 1; sig < _NSIG; sig++) {
+        if (sigaction(sig, NULL, &old) == 0 &&
+            old.sa_handler != SIG_IGN && old.sa_handler != SIG_DFL)
+            sigaction(sig, &sa, NULL);
+    }
+
+    if (args->stdin_fd > 0 && dup2(args->stdin_fd, 0) < 0)
+        goto fail;
+    if (dup2(args->out_fd, 1) < 0 || dup2(args->out_fd, 2) < 0)
+        goto fail;
+    close(args->out_fd);
+
+    if (chdir(args->root) < 0)
+        goto fail;
+    if (strcmp(args->root, "/") && (chroot(args->root) < 0 || chdir("/") < 0))
+        goto fail;
+
+    sigprocmask(SIG_SETMASK, args->sigmask, NULL);
+
+    /* the same search execvp does */
+    for (i = 0; args->candidates[i]; i++) {
+        execve(args->candidates[i], args->argv, args->envp);
+        if (errno == EACCES)
+            err = EACCES;
+        else if (errno != ENOENT && errno != ENOTDIR) {
+            err = errno;
+            break;
+        }
+    }
+
+    args->err = err;
+    _exit(127);
+
+fail:
+    args->err = errno;
+    _exit(127);
+}
+
+static void free_strings(char **strings) {
+    char **s;
+
+    if (!strings)
+        return;
+
+    for (s = strings; *s; s++)
+        free(*s);
+    free(strings);
+}
+
+/* Return the paths to try for command, looked up in path like execvp. */
+static char **spawn_candidates(const char *command, const char *path) {
+    const char *dir, *sep;
+    char **candidates;
+    size_t count = 2, dirlen, i = 0;
+
+    if (strchr(command, '/')) {
+        candidates = calloc(2, sizeof(char *));
+        if (candidates && !(candidates[0] = strdup(command))) {
+            free(candidates);
+            return NULL;
+        }
+        return candidates;
+    }
+
+    for (dir = path; *dir; dir++) {
+        if (*dir == ':')
+            count++;
+    }
+
+    candidates = calloc(count, sizeof(char *));
+    if (!candidates)
+        return NULL;
+
+    for (dir = path; ; dir = sep + 1) {
+        sep = strchrnul(dir, ':');
+        dirlen = sep - dir;
+
+        /* an empty entry means the current directory */
+        candidates[i] = malloc(dirlen + strlen(command) + 2);
+        if (!candidates[i]) {
+            free_strings(candidates);
+            return NULL;
+        }
+        if (dirlen)
+            sprintf(candidates[i], "%.*s/%s", (int) dirlen, dir, command);
+        else
+            strcpy(candidates[i], command);
+        i++;
+
+        if (!*sep)
+            break;
+    }
+
+    return candidates;
+}
+
+/* spawn(argv, env, root, stdin_fd) -> (pid, fd)
+ *
+ * Run argv[0], searched for in the PATH of the env dictionary, with the
+ * arguments argv and the environment env, chrooted to root, with stdin
+ * read from stdin_fd (-1 to inherit it) and stdout and stderr going to a
+ * pipe.  Returns the pid of the child and the read end of the pipe.
+ *
+ * The child is started with clone(CLONE_VM | CLONE_VFORK), so its cost
+ * does not grow with the size of anaconda the way fork's does, and all
+ * of the setup is done in C.  If the command cannot be run, OSError is
+ * raised the same way subprocess.Popen would raise it.
+ */
+static PyObject * doSpawn(PyObject *s, PyObject *args) {
+    PyObject *argv_list, *env_dict, *key, *value;
+    struct spawn_args spawn;
+    const char *root, *path = "/bin:/usr/bin";
+    char *stack = NULL;
+    sigset_t all, old;
+    Py_ssize_t argc, i, pos = 0;
+    int fds[2], fd, stdin_fd, err = 0;
+    pid_t pid = -1;
+
+    if (!PyArg_ParseTuple(args, "O!O!si", &PyList_Type, &argv_list,
+                          &PyDict_Type, &env_dict, &root, &stdin_fd))
+        return NULL;
+
+    argc = PyList_Size(argv_list);
+    if (argc < 1) {
+        PyErr_SetString(PyExc_ValueError, "argv must not be empty");
+        return NULL;
+    }
+
+    memset(&spawn, 0, sizeof(spawn));
+    spawn.root = root;
+    spawn.stdin_fd = stdin_fd;
+    spawn.sigmask = &old;
+
+    /* Everything the child needs is prepared here, it cannot allocate. */
+    spawn.argv = calloc(argc + 1, sizeof(char *));
+    spawn.envp = calloc(PyDict_Size(env_dict) + 1, sizeof(char *));
+    if (!spawn.argv || !spawn.envp) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    for (i = 0; i < argc; i++) {
+        /* borrowed from the list, which outlives the child's exec */
+        if (!(spawn.argv[i] = PyString_AsString(PyList_GET_ITEM(argv_list, i))))
+            goto out;
+    }
+
+    i = 0;
+    while (PyDict_Next(env_dict, &pos, &key, &value)) {
+        const char *k = PyString_AsString(key), *v = PyString_AsString(value);
+
+        if (!k || !v)
+            goto out;
+        if (!(spawn.envp[i] = malloc(strlen(k) + strlen(v) + 2))) {
+            PyErr_NoMemory();
+            goto out;
+        }
+        sprintf(spawn.envp[i++], "%s=%s", k, v);
+        if (!strcmp(k, "PATH"))
+            path = v;
+    }
+
+    spawn.candidates = spawn_candidates(spawn.argv[0], path);
+    stack = malloc(SPAWN_STACK_SIZE);
+    if (!spawn.candidates || !stack) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        goto out;
+    }
+
+    /* keep the write end clear of the fds the child is going to replace */
+    if (fds[1] < 3) {
+        fd = fcntl(fds[1], F_DUPFD_CLOEXEC, 3);
+        if (fd < 0) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            close(fds[0]);
+            close(fds[1]);
+            goto out;
+        }
+        close(fds[1]);
+        fds[1] = fd;
+    }
+    spawn.out_fd = fds[1];
+
+    Py_BEGIN_ALLOW_THREADS
+    /* no signal handlers may run in the child before it resets them */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pid = clone(spawn_child, stack + SPAWN_STACK_SIZE,
+                CLONE_VM | CLONE_VFORK | SIGCHLD, &spawn);
+    if (pid < 0)
+        err = errno;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    /* the child has exec'd or exited by now */
+    if (pid > 0 && spawn.err) {
+        err = spawn.err;
+        while (waitpid(pid, NULL, 0) < 0 && errno == EINTR)
+            ;
+    }
+    Py_END_ALLOW_THREADS
+
+    close(fds[1]);
+    if (err) {
+        close(fds[0]);
+        errno = err;
+        if (pid > 0)
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, spawn.argv[0]);
+        else
+            PyErr_SetFromErrno(PyExc_OSError);
+        pid = -1;
+    }
+
+out:
+    free(stack);
+    free(spawn.argv);
+    free_strings(spawn.envp);
+    free_strings(spawn.candidates);
+
+    if (pid < 0)
+        return NULL;
+
+    return Py_BuildValue("(ii)", pid, fds[0]);
+}
 
 /* vim:set shiftwidth=4 softtabstop=4: */
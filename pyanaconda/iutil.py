@@ -25,12 +25,17 @@ import os
 import stat
 import os.path
 import errno
+import threading
 import subprocess
 import unicodedata
 import string
 import types
-from threading import Thread
-from Queue import Queue, Empty
+
+try:
+    from pyanaconda import _isys
+except ImportError:
+    # testing mode, see pyanaconda/isys/__init__.py
+    import _isys
 
 from pyanaconda.flags import flags
 from pyanaconda.constants import DRACUT_SHUTDOWN_EJECT, ROOT_PATH, TRANSLATIONS_UPDATE_DIR, UNSUPPORTED_HW
@@ -49,6 +54,113 @@ def augmentEnv():
                })
     return env
 
+class _SpawnedProcess(object):
+    """ The part of the subprocess.Popen interface the exec functions need,
+        for a command started by _isys.spawn.
+    """
+    def __init__(self, pid, fd):
+        self.pid = pid
+        self.stdout = os.fdopen(fd, "rb")
+        self.returncode = None
+
+    def _wait(self, options):
+        while True:
+            try:
+                pid, status = os.waitpid(self.pid, options)
+                break
+            except OSError as e:
+                if e.errno == errno.EINTR:
+                    continue
+                if e.errno != errno.ECHILD:
+                    raise
+                # reaped by someone else, assume it succeeded like Popen does
+                pid, status = self.pid, 0
+                break
+
+        if pid == self.pid:
+            if os.WIFSIGNALED(status):
+                self.returncode = -os.WTERMSIG(status)
+            else:
+                self.returncode = os.WEXITSTATUS(status)
+            with _unreaped_lock:
+                if self in _unreaped:
+                    _unreaped.remove(self)
+        return self.returncode
+
+    def poll(self):
+        """ Return the exit code or None if the command is still running. """
+        if self.returncode is None:
+            self._wait(os.WNOHANG)
+
+        # remember to reap it later, like Popen does on garbage collection
+        if self.returncode is None:
+            with _unreaped_lock:
+                if self not in _unreaped:
+                    _unreaped.append(self)
+        return self.returncode
+
+    def wait(self):
+        if self.returncode is None:
+            self._wait(0)
+        return self.returncode
+
+    def communicate(self):
+        try:
+            output = self.stdout.read()
+        finally:
+            self.stdout.close()
+        self.wait()
+        return (output, None)
+
+_unreaped = []
+_unreaped_lock = threading.Lock()
+
+# number of blocks of lines logged to program.log, see _run_program
+_program_log_blocks = 0
+
+def _log_running(argv):
+    """ Log the start of a command and return the number of the block. """
+    global _program_log_blocks
+
+    with program_log_lock:
+        program_log.info("Running... %s", " ".join(argv))
+        _program_log_blocks += 1
+        return _program_log_blocks
+
+def _spawn(argv, stdin=None, root='/', env_prune=None):
+    """ Start a command with its stdout and stderr going to a pipe.
+
+        This replaces subprocess.Popen with a chroot preexec_fn, which has to
+        fork all of anaconda and run Python code in the child.  _isys.spawn
+        does the chroot, chdir and fd setup in C in a vfork-like child, so
+        starting a command costs the same however big anaconda has grown.
+
+        :param argv: The command to run and its arguments
+        :param stdin: The file object or fd to read stdin from, None to inherit it
+        :param root: The directory to chroot to before running command.
+        :param env_prune: environment variables to remove before execution
+        :return: a _SpawnedProcess for the command
+    """
+    # reap the commands execReadlines left running
+    with _unreaped_lock:
+        leftover = _unreaped[:]
+    for proc in leftover:
+        proc._wait(os.WNOHANG)
+
+    env = augmentEnv()
+    for var in env_prune or []:
+        env.pop(var, None)
+
+    if stdin is None:
+        stdin_fd = -1
+    elif isinstance(stdin, int):
+        stdin_fd = stdin
+    else:
+        stdin_fd = stdin.fileno()
+
+    pid, fd = _isys.spawn(list(argv), env, root or '/', stdin_fd)
+    return _SpawnedProcess(pid, fd)
+
 def _run_program(argv, root='/', stdin=None, stdout=None, env_prune=None, log_output=True, binary_output=False):
     """ Run an external program, log the output and return it to the caller
         :param argv: The command to run and argument
@@ -60,47 +172,41 @@ def _run_program(argv, root='/', stdin=None, stdout=None, env_prune=None, log_ou
         :param binary_output: whether to treat the output of command as binary data
         :return: The return code of the command and the output
     """
-    if env_prune is None:
-        env_prune = []
+    global _program_log_blocks
 
-    def chroot():
-        if root and root != '/':
-            os.chroot(root)
-            os.chdir("/")
+    # The lock only keeps the lines of one command together in the log, it
+    # is not held while the command runs so that commands can run in
+    # parallel.  The output is logged when the command is done.
+    block = _log_running(argv)
 
-    with program_log_lock:
-        program_log.info("Running... %s", " ".join(argv))
-
-        env = augmentEnv()
-        for var in env_prune:
-            env.pop(var, None)
-
-        try:
-            proc = subprocess.Popen(argv,
-                                    stdin=stdin,
-                                    stdout=subprocess.PIPE,
-                                    stderr=subprocess.STDOUT,
-                                    preexec_fn=chroot, cwd=root, env=env)
-
-            output_string = proc.communicate()[0]
-            if output_string:
-                if binary_output:
-                    output_lines = [output_string]
-                else:
-                    if output_string[-1] != "\n":
-                        output_string = output_string + "\n"
-                    output_lines = output_string.splitlines(True)
-
-                for line in output_lines:
-                    if log_output:
-                        program_log.info(line.strip())
-
-                    if stdout:
-                        stdout.write(line)
-
-        except OSError as e:
+    try:
+        proc = _spawn(argv, stdin=stdin, root=root, env_prune=env_prune)
+        output_string = proc.communicate()[0]
+    except OSError as e:
+        with program_log_lock:
             program_log.error("Error running %s: %s", argv[0], e.strerror)
-            raise
+        raise
+
+    with program_log_lock:
+        # say whose output this is if something else was logged in between
+        if block != _program_log_blocks:
+            program_log.info("Output of... %s", " ".join(argv))
+        _program_log_blocks += 1
+
+        if output_string:
+            if binary_output:
+                output_lines = [output_string]
+            else:
+                if output_string[-1] != "\n":
+                    output_string = output_string + "\n"
+                output_lines = output_string.splitlines(True)
+
+            for line in output_lines:
+                if log_output:
+                    program_log.info(line.strip())
+
+                if stdout:
+                    stdout.write(line)
 
         program_log.debug("Return code: %d", proc.returncode)
 
@@ -160,52 +266,36 @@ def execReadlines(command, argv, stdin=None, root='/', env_prune=None):
         Output from the file is not logged to program.log
         This returns a generator with the lines from the command until it has finished
     """
-    if env_prune is None:
-        env_prune = []
-
-    # Return the lines from stdout via a Queue
-    def queue_lines(out, queue):
-        for line in iter(out.readline, b''):
-            queue.put(line.strip())
-        out.close()
-
-    def chroot():
-        if root and root != '/':
-            os.chroot(root)
-            os.chdir("/")
-
     argv = [command] + argv
-    with program_log_lock:
-        program_log.info("Running... %s", " ".join(argv))
+    _log_running(argv)
 
-    env = augmentEnv()
-    for var in env_prune:
-        env.pop(var, None)
     try:
-        proc = subprocess.Popen(argv,
-                                stdin=stdin,
-                                stdout=subprocess.PIPE,
-                                stderr=subprocess.STDOUT,
-                                bufsize=1,
-                                preexec_fn=chroot, cwd=root, env=env)
+        proc = _spawn(argv, stdin=stdin, root=root, env_prune=env_prune)
     except OSError as e:
         program_log.error("Error running %s: %s", argv[0], e.strerror)
         raise
 
-    q = Queue()
-    t = Thread(target=queue_lines, args=(proc.stdout, q))
-    t.daemon = True # thread dies with the program
-    t.start()
-
-    while True:
-        try:
-            line = q.get(timeout=.1)
-            yield line
-            q.task_done()
-        except Empty:
-            if proc.poll() is not None:
+    # _isys.read_lines reads the pipe in large chunks and splits the lines
+    # in C, a progress-heavy command can print tens of thousands of them
+    fd = proc.stdout.fileno()
+    partial = b""
+    try:
+        while True:
+            lines, partial, eof = _isys.read_lines(fd, partial, 100)
+            for line in lines:
+                yield line
+
+            # Stop when the command is done even if a child of it keeps the
+            # pipe open.
+            if eof or (not lines and proc.poll() is not None):
                 break
-    q.join()
+
+        partial = partial.strip()
+        if partial:
+            yield partial
+    finally:
+        proc.stdout.close()
+        proc.poll()
 
 
 ## Run a shell.
@@ -0,0 +1,121 @@
+#
+# lazyimport.py: deferred and background imports of heavy modules
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Deferred imports for the anaconda entry point.
+
+   lazy_import() returns a stand-in for a module that is only imported
+   when one of its attributes is used, so a text, cmdline or kickstart
+   installation never pays for modules it does not touch.  preload()
+   imports modules that are going to be needed in a background thread,
+   while the main thread waits for something else, like X to start.
+
+   Every import done here is timed, logged and recorded in the trace.
+"""
+
+import importlib
+import sys
+import threading
+import time
+import types
+
+from pyanaconda.trace import tracer
+
+import logging
+log = logging.getLogger("anaconda")
+
+CAT_IMPORT = "import"
+
+# name -> seconds it took to import the module
+import_times = {}
+
+def import_module(name):
+    """Import the module with the given name, timing how long it took."""
+    module = sys.modules.get(name)
+    if module is not None:
+        return module
+
+    start = time.time()
+    with tracer.span(name, CAT_IMPORT):
+        module = importlib.import_module(name)
+
+    import_times[name] = time.time() - start
+    log.debug("imported %s in %.3f s", name, import_times[name])
+    return module
+
+class LazyModule(types.ModuleType):
+    """A stand-in for a module that imports it on first attribute access."""
+
+    def __init__(self, name):
+        types.ModuleType.__init__(self, name)
+        self.__dict__["_lazy_module"] = None
+        self.__dict__["_lazy_lock"] = threading.Lock()
+
+    def _load(self):
+        module = self.__dict__["_lazy_module"]
+        if module is None:
+            with self.__dict__["_lazy_lock"]:
+                module = self.__dict__["_lazy_module"]
+                if module is None:
+                    module = import_module(self.__name__)
+                    self.__dict__["_lazy_module"] = module
+        return module
+
+    def __getattr__(self, attr):
+        return getattr(self._load(), attr)
+
+    def __setattr__(self, attr, value):
+        setattr(self._load(), attr, value)
+
+    def __repr__(self):
+        if self.__dict__["_lazy_module"] is None:
+            return "<lazy module '%s' (not loaded)>" % self.__name__
+        return repr(self.__dict__["_lazy_module"])
+
+def lazy_import(name):
+    """Return a LazyModule for the module with the given name, or the module
+       itself if it is already imported.
+    """
+    return sys.modules.get(name) or LazyModule(name)
+
+def _preload_modules(names):
+    start = time.time()
+    for name in names:
+        try:
+            import_module(name)
+        except ImportError as e:
+            log.warning("failed to preload %s: %s", name, e)
+
+    log.info("preloaded %d modules in %.3f s", len(names), time.time() - start)
+
+def preload(names):
+    """Import the given modules in a background thread.
+
+       Python 2 serializes imports with one global lock, so this only helps
+       while the main thread does something other than importing.  Only
+       preload modules that are going to be needed anyway.
+    """
+    from pyanaconda.threads import threadMgr, AnacondaThread
+    from pyanaconda.constants import THREAD_PRELOAD_MODULES
+
+    names = [name for name in names if name not in sys.modules]
+    if not names:
+        return
+
+    threadMgr.add(AnacondaThread(name=THREAD_PRELOAD_MODULES, target=_preload_modules,
+                                 args=(names,), fatal=False))
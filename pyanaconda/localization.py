@@ -200,6 +200,26 @@ def setup_locale(locale, lang=None):
     os.environ["LANG"] = locale
     locale_mod.setlocale(locale_mod.LC_ALL, locale)
 
+def preload_translations(locales):
+    """
+    Load the installer's translations for the given locales in a background
+    thread, so that switching to one of them does not have to wait for the
+    message catalog to be read.
+
+    :param locales: locales that are likely to be chosen
+    :type locales: list of strings
+    :return: None
+    :rtype: None
+
+    """
+
+    from pyanaconda.i18n import preload_catalogs
+    from pyanaconda.threads import threadMgr, AnacondaThread
+
+    if locales and not threadMgr.get(constants.THREAD_PRELOAD_TRANSLATIONS):
+        threadMgr.add(AnacondaThread(name=constants.THREAD_PRELOAD_TRANSLATIONS,
+                                     target=preload_catalogs, args=(list(locales),)))
+
 def get_english_name(locale):
     """
     Function returning english name for the given locale.
@@ -34,12 +34,14 @@ from urlgrabber.grabber import URLGrabError
 import ConfigParser
 import shutil
 import time
+import multiprocessing
+import urlparse
 
 if __name__ == "__main__":
     from pyanaconda import anaconda_log
     anaconda_log.init()
 
-from pyanaconda.constants import ROOT_PATH, DRACUT_ISODIR, DRACUT_REPODIR, GROUP_ALL, GROUP_DEFAULT, GROUP_REQUIRED, DD_ALL, DD_FIRMWARE, DD_RPMS, INSTALL_TREE, ISO_DIR, THREAD_STORAGE, THREAD_WAIT_FOR_CONNECTING_NM
+from pyanaconda.constants import ROOT_PATH, DRACUT_ISODIR, DRACUT_REPODIR, GROUP_ALL, GROUP_DEFAULT, GROUP_REQUIRED, DD_ALL, DD_FIRMWARE, DD_RPMS, INSTALL_TREE, ISO_DIR, THREAD_STORAGE, THREAD_WAIT_FOR_CONNECTING_NM, THREAD_INITRD_BASENAME, THREAD_REPO_METADATA_BASENAME
 from pyanaconda.flags import flags
 
 from pyanaconda import iutil
@@ -102,6 +104,137 @@ class DependencyError(PayloadError):
 class PayloadInstallError(PayloadError):
     pass
 
+# rough peak memory of one dracut run in kB, used to size the worker pool
+DRACUT_MEMORY = 512 * 1024
+
+def kernelWorkers(count):
+    """ Return how many of count initramfs images to generate at the same
+        time, bounded by the number of CPUs and by the available memory.
+    """
+    memory = isys.available_memory()
+    if memory is None:
+        memory = isys.total_memory() / 2
+
+    return max(1, min(count, multiprocessing.cpu_count(), memory / DRACUT_MEMORY))
+
+def _runInGraph(description, basename, items, task, resource_limits):
+    """ Call task(item) for each of the (item, resources) tuples in items on
+        a TaskGraph limited by resource_limits, wait for all of them and log
+        how long each one took.
+
+        :param str description: what the task does, for the log
+        :param str basename: prefix of the names of the threads
+        :returns: dict mapping the items task raised an exception for to the
+                  sys.exc_info() of the exception
+    """
+    from pyanaconda.threads import threadMgr, TaskGraph
+
+    errors = {}
+    if not items:
+        return errors
+
+    start = time.time()
+    def run(item):
+        item_start = time.time()
+        try:
+            task(item)
+        except Exception as e: # pylint: disable=broad-except
+            log.info("%s for %s failed after %.1f s: %s", description, item,
+                     time.time() - item_start, e)
+            errors[item] = sys.exc_info()
+        else:
+            log.info("%s for %s took %.1f s", description, item, time.time() - item_start)
+
+    graph = TaskGraph(description, resource_limits=resource_limits)
+    names = []
+    for item, resources in items:
+        name = "%s-%s" % (basename, item)
+        graph.add(name, run, args=(item,), resources=resources)
+        names.append(name)
+
+    graph.run()
+    for name in names:
+        threadMgr.wait(name)
+
+    log.info("%s for %d item(s) took %.1f s", description, len(items), time.time() - start)
+    return errors
+
+def runPerKernel(description, kernels, task, workers=None):
+    """ Call task(kernel) for each of the kernels, on at most workers threads
+        at the same time, and log how long each one took.
+
+        A failure for one kernel does not stop the others.  The first
+        exception raised by task is raised again once all of them are done.
+
+        :param str description: what the task does, for the log
+        :param kernels: kernel versions
+        :param task: function taking the kernel version and returning the
+                     exit code of the command it ran
+        :param int workers: the size of the pool, see kernelWorkers for the default
+    """
+    from pyanaconda.threads import RESOURCE_CPU
+
+    if not kernels:
+        return
+
+    if workers is None:
+        workers = kernelWorkers(len(kernels))
+    log.info("%s for %d kernel(s) using %d worker(s)", description, len(kernels), workers)
+
+    def run(kernel):
+        rc = task(kernel)
+        if rc:
+            log.error("%s for %s failed with exit code %d", description, kernel, rc)
+
+    errors = _runInGraph(description, THREAD_INITRD_BASENAME,
+                         [(kernel, (RESOURCE_CPU,)) for kernel in kernels],
+                         run, {RESOURCE_CPU: workers})
+
+    failed = [kernel for kernel in kernels if kernel in errors]
+    for kernel in failed:
+        log.error("%s for %s failed", description, kernel, exc_info=errors[kernel])
+    if failed:
+        exc_info = errors[failed[0]]
+        raise exc_info[0], exc_info[1], exc_info[2]
+
+# how many repos to fetch metadata for at the same time, in total and from
+# a single host
+REPO_FETCHES = 8
+REPO_HOST_FETCHES = 2
+
+# seconds the metadata of a single repo may take to download
+REPO_METADATA_TIMEOUT = 300
+
+def runPerRepo(description, repos, task):
+    """ Call task(repo_id) for all of the repos at the same time, fetching
+        from at most REPO_HOST_FETCHES repos on the same host at once, and
+        log how long each one took.
+
+        A failure for one repo does not stop the others.
+
+        :param str description: what the task does, for the log
+        :param repos: list of (repo id, URL of the repo) tuples
+        :param task: function taking the repo id
+        :returns: dict mapping the ids of the repos task raised an exception
+                  for to the exception
+    """
+    from pyanaconda.threads import RESOURCE_NETWORK
+
+    limits = {RESOURCE_NETWORK: REPO_FETCHES}
+    items = []
+    for repo_id, url in repos:
+        host = urlparse.urlparse(url or "").hostname
+        if host:
+            # every host is a resource class of its own
+            resources = ("host:" + host, RESOURCE_NETWORK)
+            limits[resources[0]] = REPO_HOST_FETCHES
+        else:
+            resources = ()
+        items.append((repo_id, resources))
+
+    errors = _runInGraph(description, THREAD_REPO_METADATA_BASENAME, items, task, limits)
+    return dict((repo_id, exc_info[1]) for (repo_id, exc_info) in errors.items())
+
 class Payload(object):
     """ Payload is an abstract class for OS install delivery methods. """
     def __init__(self, data):
@@ -526,7 +659,7 @@ class Payload(object):
                 #           prevent boot on some systems
 
     def recreateInitrds(self, force=False):
-        """ Recreate the initrds by calling new-kernel-pkg
+        """ Recreate the initrds by calling dracut and new-kernel-pkg
 
             This needs to be done after all configuration files have been
             written, since dracut depends on some of them.
@@ -538,22 +671,37 @@ class Payload(object):
         if not force and self._createdInitrds:
             return
 
-        for kernel in self.kernelVersionList:
+        # dracut is slow and single threaded, so the images are generated
+        # in parallel.  new-kernel-pkg --update also edits the bootloader
+        # configuration, which must not happen concurrently, so that part
+        # runs afterwards, one kernel at a time.
+        def generate(kernel):
             log.info("recreating initrd for %s", kernel)
             if not flags.imageInstall:
-                iutil.execWithRedirect("new-kernel-pkg",
-                                       ["--mkinitrd", "--dracut",
-                                        "--depmod", "--update", kernel],
-                                       root=ROOT_PATH)
+                rc = iutil.execWithRedirect("depmod", ["-a", kernel], root=ROOT_PATH)
+                if rc:
+                    return rc
+
+                return iutil.execWithRedirect("dracut",
+                                              ["-f", "/boot/initramfs-%s.img" % kernel,
+                                               kernel],
+                                              root=ROOT_PATH)
             else:
                 # hostonly is not sensible for disk image installations
                 # using /dev/disk/by-uuid/ is necessary due to disk image naming
-                iutil.execWithRedirect("dracut",
-                                       ["-N",
-                                        "--persistent-policy", "by-uuid",
-                                        "-f", "/boot/initramfs-%s.img" % kernel,
-                                        kernel],
-                                        root=ROOT_PATH)
+                return iutil.execWithRedirect("dracut",
+                                              ["-N",
+                                               "--persistent-policy", "by-uuid",
+                                               "-f", "/boot/initramfs-%s.img" % kernel,
+                                               kernel],
+                                              root=ROOT_PATH)
+
+        runPerKernel("Generating initramfs", self.kernelVersionList, generate)
+
+        if not flags.imageInstall:
+            for kernel in self.kernelVersionList:
+                iutil.execWithRedirect("new-kernel-pkg", ["--update", kernel],
+                                       root=ROOT_PATH)
 
         self._createdInitrds = True
 
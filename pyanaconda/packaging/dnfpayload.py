@@ -23,11 +23,13 @@
 from blivet.size import Size
 from pyanaconda.flags import flags
 from pyanaconda.i18n import _
+from pyanaconda.packaging.repocache import metadataCache
 from pyanaconda.progress import progressQ
 
 import itertools
 import logging
 import multiprocessing
+import os
 import pyanaconda.constants as constants
 import pyanaconda.errors as errors
 import pyanaconda.packaging as packaging
@@ -206,7 +208,23 @@ class DNFPayload(packaging.PackagePayload):
         else:
             log.error('kernel: failed to select a kernel from %s', kernels)
 
+    @staticmethod
+    def _metadata_paths(dnf_repo):
+        # the repo's own cache and the solv files hawkey makes of it
+        return {'repo': dnf_repo.cachedir,
+                'solv': os.path.join(DNF_CACHE_DIR, '%s.solv' % dnf_repo.id),
+                'filenames': os.path.join(DNF_CACHE_DIR,
+                                          '%s-filenames.solvx' % dnf_repo.id)}
+
+    @staticmethod
+    def _metadata_url(dnf_repo):
+        return dnf_repo.baseurl[0] if dnf_repo.baseurl else dnf_repo.mirrorlist
+
     def _sync_metadata(self, dnf_repo):
+        # DNF checks whether restored metadata is current itself, comparing
+        # repomd.xml with the one upstream once it expires
+        metadataCache.restore(self._metadata_url(dnf_repo),
+                              self._metadata_paths(dnf_repo))
         try:
             dnf_repo.load()
         except dnf.exceptions.RepoError as e:
@@ -335,7 +353,19 @@ class DNFPayload(packaging.PackagePayload):
         return (grp.ui_name, grp.ui_description)
 
     def gatherRepoMetadata(self):
-        map(self._sync_metadata, self._base.repos.iter_enabled())
+        # librepo downloads without holding the GIL, so load all of the repos
+        # at the same time; the timeouts are librepo's own per connection
+        repos = list(self._base.repos.iter_enabled())
+        by_id = dict((repo.id, repo) for repo in repos)
+        errors = packaging.runPerRepo(
+            "loading repo metadata",
+            [(repo.id, self._metadata_url(repo)) for repo in repos],
+            lambda repo_id: self._sync_metadata(by_id[repo_id]))
+        failed = [repo.id for repo in repos if repo.id in errors]
+        for repo_id in failed:
+            log.error("failed to load metadata of repo %s: %s", repo_id, errors[repo_id])
+        if failed:
+            raise errors[failed[0]]
         self._base.fill_sack(load_system_repo=False)
         self._base.read_comps()
 
@@ -393,6 +423,9 @@ class DNFPayload(packaging.PackagePayload):
     def reset(self, root=None, releasever=None):
         super(DNFPayload, self).reset()
         self.txID = None
+        for repo in self._base.repos.iter_enabled():
+            metadataCache.store(self._metadata_url(repo),
+                                self._metadata_paths(repo))
         self._base.reset(sack=True, repos=True)
 
     def selectEnvironment(self, environmentid):
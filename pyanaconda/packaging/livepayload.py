@@ -40,7 +40,7 @@ import urllib
 import hashlib
 import glob
 
-from pyanaconda.packaging import ImagePayload, PayloadSetupError, PayloadInstallError
+from pyanaconda.packaging import ImagePayload, PayloadSetupError, PayloadInstallError, runPerKernel
 
 from pyanaconda.constants import INSTALL_TREE, ROOT_PATH, THREAD_LIVE_PROGRESS
 from pyanaconda.constants import IMAGE_DIR
@@ -149,12 +149,15 @@ class LiveImagePayload(ImagePayload):
 
         super(LiveImagePayload, self).postInstall()
 
-        # Live needs to create the rescue image before bootloader is written
-        for kernel in self.kernelVersionList:
-            log.info("Generating rescue image for %s", kernel)
-            iutil.execWithRedirect("new-kernel-pkg",
-                                   ["--rpmposttrans", kernel],
-                                   root=ROOT_PATH)
+        # Live needs to create the rescue image before bootloader is written.
+        # The posttrans scripts of all of the kernels share the one rescue
+        # image and the bootloader configuration, so they run one at a time.
+        def rescue(kernel):
+            return iutil.execWithRedirect("new-kernel-pkg",
+                                          ["--rpmposttrans", kernel],
+                                          root=ROOT_PATH)
+
+        runPerKernel("Generating rescue image", self.kernelVersionList, rescue, workers=1)
 
         # Make sure the new system has a machine-id, it won't boot without it
         if not os.path.exists(ROOT_PATH+"/etc/machine-id"):
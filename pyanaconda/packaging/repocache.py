@@ -0,0 +1,160 @@
+#
+# repocache.py: repository metadata kept across payload resets
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Repository metadata kept across payload resets.
+
+   yum and DNF keep the metadata of a repo in a directory named after the
+   repo id, so the payloads have to throw it away whenever the source of a
+   repo changes.  Going back to a source used before then means downloading
+   and parsing all of its metadata again.
+
+   Instead, the payloads hand the metadata of a repo that goes away to
+   RepoMetadataCache.store(), which files it under the URL of the repo, and
+   get it back with restore() when a repo with that URL is set up again.
+   Both the downloaded files and what yum and DNF made of them (the sqlite
+   databases and the solv files) are kept, so nothing needs to be parsed
+   again either.  Everything lives in /tmp and is moved around with rename,
+   so storing and restoring are cheap.
+"""
+
+import hashlib
+import os
+import shutil
+import threading
+
+from pyanaconda.iutil import mkdirChain
+
+import logging
+log = logging.getLogger("packaging")
+
+METADATA_CACHE_DIR = "/tmp/repo-metadata.cache"
+
+def file_checksum(path):
+    """Return the sha256 of the file's contents or None if it can't be read."""
+    digest = hashlib.sha256()
+    try:
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(65536), ""):
+                digest.update(block)
+    except IOError:
+        return None
+    return digest.hexdigest()
+
+def _merge(src, dst):
+    """Move src to dst.  Where dst already exists it wins, except that the
+       contents of directories are merged.
+    """
+    if not os.path.lexists(dst):
+        shutil.move(src, dst)
+    elif os.path.isdir(src) and not os.path.islink(src) and os.path.isdir(dst):
+        for name in os.listdir(src):
+            _merge(os.path.join(src, name), os.path.join(dst, name))
+
+class RepoMetadataCache(object):
+    """Metadata of repos that are not set up right now, by URL.  All of the
+       methods are thread safe.
+    """
+
+    # the metadata of a distribution tree is big and /tmp is in memory,
+    # so only keep the sources used most recently
+    MAX_ENTRIES = 4
+
+    def __init__(self, path=METADATA_CACHE_DIR):
+        self._path = path
+        self._lock = threading.Lock()
+
+    def _entry(self, url):
+        return os.path.join(self._path, hashlib.sha1(url).hexdigest())
+
+    def _prune(self):
+        # called with self._lock held
+        entries = [os.path.join(self._path, name) for name in os.listdir(self._path)]
+        entries.sort(key=os.path.getmtime, reverse=True)
+        for entry in entries[self.MAX_ENTRIES:]:
+            shutil.rmtree(entry, ignore_errors=True)
+
+    def store(self, url, paths):
+        """Move the metadata of the repo at url to the cache.  paths maps a
+           name to each file or directory that makes up the metadata; any of
+           them that do not exist are skipped.  What was stored for url
+           before is replaced.
+        """
+        if not url:
+            return
+
+        paths = dict((name, path) for name, path in paths.items() if os.path.lexists(path))
+        if not paths:
+            return
+
+        entry = self._entry(url)
+        with self._lock:
+            try:
+                if os.path.exists(entry):
+                    shutil.rmtree(entry)
+                mkdirChain(entry)
+                for name, path in paths.items():
+                    shutil.move(path, os.path.join(entry, name))
+                self._prune()
+            except (IOError, OSError) as e:
+                log.warning("failed to keep the metadata of %s: %s", url, e)
+                shutil.rmtree(entry, ignore_errors=True)
+                for path in paths.values():
+                    if os.path.isdir(path):
+                        shutil.rmtree(path, ignore_errors=True)
+                    elif os.path.lexists(path):
+                        os.unlink(path)
+                return
+
+        log.debug("kept the metadata of %s", url)
+
+    def restore(self, url, paths, repomd=None):
+        """Move the metadata stored for url back to the paths given for each
+           name, next to anything already there.  If repomd is given, the
+           stored metadata is only used if its repomd.xml, stored under the
+           name "repo", is the same as that file; otherwise it is out of date
+           and dropped.  Return whether anything was restored.
+        """
+        if not url:
+            return False
+
+        entry = self._entry(url)
+        with self._lock:
+            if not os.path.isdir(entry):
+                return False
+
+            try:
+                if repomd is not None:
+                    stored = file_checksum(os.path.join(entry, "repo", "repomd.xml"))
+                    if stored is None or stored != file_checksum(repomd):
+                        log.debug("metadata kept for %s is out of date", url)
+                        return False
+
+                for name, path in paths.items():
+                    if os.path.lexists(os.path.join(entry, name)):
+                        _merge(os.path.join(entry, name), path)
+            except (IOError, OSError) as e:
+                log.warning("failed to restore the metadata of %s: %s", url, e)
+                return False
+            finally:
+                shutil.rmtree(entry, ignore_errors=True)
+
+        log.debug("restored the metadata of %s", url)
+        return True
+
+metadataCache = RepoMetadataCache()
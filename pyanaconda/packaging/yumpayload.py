@@ -36,10 +36,15 @@
 """
 
 import ConfigParser
+import hashlib
+import httplib
 import os
 import shutil
 import sys
 import time
+import fcntl
+import urllib2
+import urlparse
 from pyanaconda.iutil import execReadlines
 from functools import wraps
 
@@ -62,7 +67,8 @@ except ImportError:
     log.error("import of yum failed")
     yum = None
 
-from pyanaconda.constants import BASE_REPO_NAME, DRACUT_ISODIR, INSTALL_TREE, ISO_DIR, MOUNT_DIR, ROOT_PATH
+from pyanaconda.constants import BASE_REPO_NAME, DRACUT_ISODIR, INSTALL_TREE, ISO_DIR, MOUNT_DIR, ROOT_PATH, \
+                                 THREAD_INSTALL_PROGRESS
 from pyanaconda.flags import flags
 
 from pyanaconda import iutil
@@ -75,10 +81,13 @@ import blivet.util
 import blivet.arch
 
 from pyanaconda.errors import ERROR_RAISE, errorHandler
+from pyanaconda.packaging.repocache import metadataCache
 from pyanaconda.packaging import DependencyError, MetadataError, NoNetworkError, NoSuchGroup, \
                                  NoSuchPackage, PackagePayload, PayloadError, PayloadInstallError, \
-                                 PayloadSetupError
+                                 PayloadSetupError, REPO_METADATA_TIMEOUT, runPerRepo
 from pyanaconda.progress import progressQ
+from pyanaconda.yumprogress import ProgressReader, TransactionReport, REC_PREPARE, REC_PACKAGE_START, \
+                                  REC_PACKAGE_BYTES, REC_POST
 
 from pyanaconda.localization import langcode_matches_locale
 
@@ -88,6 +97,12 @@ YUM_PLUGINS = ["fastestmirror", "langpacks"]
 DEFAULT_REPOS = [productName.lower(), "rawhide"]
 BASE_REPO_NAMES = [BASE_REPO_NAME] + DEFAULT_REPOS
 
+# how long every package and scriptlet took, see pyanaconda.yumprogress
+INSTALL_REPORT = "/tmp/packaging-timing.log"
+
+# MiB of packages anaconda-yum may download ahead of the ones rpm installs
+DOWNLOAD_AHEAD = 256
+
 import inspect
 import threading
 _private_yum_lock = threading.RLock()
@@ -149,6 +164,60 @@ def refresh_base_repo(cond_fn=None):
 _yum_lock = YumLock()
 _yum_cache_dir = "/tmp/yum.cache"
 
+# the metadata anaconda asks yum for, fetched for all repos at once ahead of
+# it; group is only used if a repo has no group_gz
+PREFETCH_MDTYPES = ["primary", "primary_db", "group_gz", "group"]
+PREFETCH_SCHEMES = ["http", "https", "ftp"]
+
+def _downloadMetadataFile(opener, url, local, checksum, timeout, deadline):
+    """ Download url to local if its checksum matches, giving up at deadline. """
+    (sumtype, value) = checksum
+    digest = hashlib.new("sha1" if sumtype == "sha" else sumtype)
+    partial = local + ".part"
+
+    remote = opener.open(url, timeout=timeout)
+    try:
+        with open(partial, "wb") as f:
+            while True:
+                if time.time() > deadline:
+                    raise MetadataError("timed out")
+                data = remote.read(65536)
+                if not data:
+                    break
+                digest.update(data)
+                f.write(data)
+    finally:
+        remote.close()
+
+    if digest.hexdigest() != value:
+        os.unlink(partial)
+        raise MetadataError("checksum mismatch")
+
+    os.rename(partial, local)
+
+def _prefetchRepoMetadata(repo_id, downloads, proxies, timeout):
+    """ Download the files yum will ask for to where it looks for them.
+        yum and urlgrabber can only be used by one thread at a time, so this
+        uses urllib2.  It gives up on a file that cannot be downloaded
+        quickly and leaves it to yum, which reports the error as usual.
+
+        :param downloads: list of (base URLs, relative path, checksum, local path)
+    """
+    deadline = time.time() + REPO_METADATA_TIMEOUT
+    opener = urllib2.build_opener(urllib2.ProxyHandler(proxies))
+    for (urls, relpath, checksum, local) in downloads:
+        for url in urls:
+            try:
+                _downloadMetadataFile(opener, urlparse.urljoin(url.rstrip("/") + "/", relpath),
+                                      local, checksum, timeout, deadline)
+                break
+            except (IOError, OSError, ValueError, httplib.HTTPException, MetadataError) as e:
+                log.info("failed to download %s of repo %s from %s: %s", relpath, repo_id, url, e)
+                if os.path.exists(local + ".part"):
+                    os.unlink(local + ".part")
+        else:
+            log.info("leaving %s of repo %s for yum to download", relpath, repo_id)
+
 class YumPayload(PackagePayload):
     """ A YumPayload installs packages onto the target system using yum.
 
@@ -222,9 +291,8 @@ class YumPayload(PackagePayload):
             if self._yum:
                 if not keep_cache:
                     for repo in self._yum.repos.listEnabled():
-                        if repo.name == BASE_REPO_NAME and \
-                           os.path.isdir(repo.cachedir):
-                            shutil.rmtree(repo.cachedir)
+                        if repo.name == BASE_REPO_NAME:
+                            self._stashRepoMetadata(repo)
 
                 del self._yum
 
@@ -594,8 +662,60 @@ reposdir=%s
                     # if a method/repo was given, disable all default repos
                     self.disableRepo(repo.id)
 
+    def _metadataDownloads(self, yumrepo):
+        """ Return a list of the metadata files of a network repo that yum
+            does not have yet, as needed by _prefetchRepoMetadata.  Must be
+            called with _yum_lock held.
+        """
+        from yum.Errors import RepoError, RepoMDError
+
+        urls = [url for url in yumrepo.urls
+                if urlparse.urlparse(url).scheme in PREFETCH_SCHEMES]
+        if not urls:
+            return []
+
+        try:
+            filetypes = yumrepo.repoXML.fileTypes()
+        except RepoError:
+            return []
+
+        downloads = []
+        for mdtype in PREFETCH_MDTYPES:
+            if mdtype not in filetypes or (mdtype == "group" and "group_gz" in filetypes):
+                continue
+
+            try:
+                data = yumrepo.repoXML.getData(mdtype)
+            except RepoMDError:
+                continue
+
+            (base, relpath) = data.location
+            local = os.path.join(yumrepo.cachedir, os.path.basename(relpath))
+            if not os.path.exists(local):
+                downloads.append(([base] if base else urls, relpath, data.checksum, local))
+
+        return downloads
+
     @refresh_base_repo()
     def gatherRepoMetadata(self):
+        # Download what yum is going to need for all of the network repos at
+        # the same time, so that the loop below finds it in the cache.
+        repos = []
+        prefetch = {}
+        with _yum_lock:
+            for repo_id in self.repos:
+                repo = self._yum.repos.getRepo(repo_id)
+                if repo.enabled:
+                    downloads = self._metadataDownloads(repo)
+                    if downloads:
+                        repos.append((repo_id, downloads[0][0][0]))
+                        prefetch[repo_id] = (repo_id, downloads,
+                                             getattr(repo, "proxy_dict", None) or {},
+                                             repo.timeout)
+
+        runPerRepo("downloading repo metadata", repos,
+                   lambda repo_id: _prefetchRepoMetadata(*prefetch[repo_id]))
+
         # now go through and get metadata for all enabled repos
         log.info("gathering repo metadata")
         for repo_id in self.repos:
@@ -779,6 +899,7 @@ reposdir=%s
                     obj = self._yum.repos.repos[name]
                     needsAdding = False
                 else:
+                    self._stashRepoMetadata(self._yum.repos.repos[name])
                     self._yum.repos.delete(name)
 
         if proxyurl and needsAdding:
@@ -816,6 +937,9 @@ reposdir=%s
             except RepoError as e:
                 raise MetadataError(e.value)
 
+            if needsAdding:
+                self._restoreRepoMetadata(obj)
+
         # Adding a new repo means the cached packages and groups lists
         # are out of date.  Clear them out now so the next reference to
         # either will cause it to be regenerated.
@@ -829,9 +953,29 @@ reposdir=%s
         self._addYumRepo(newrepo.name, newrepo.baseurl, newrepo.mirrorlist, newrepo.proxy)   # FIXME: handle MetadataError
         super(YumPayload, self).addRepo(newrepo)
 
+    @staticmethod
+    def _repoMetadataURL(repo):
+        return repo.baseurl[0] if repo.baseurl else repo.mirrorlist
+
+    def _stashRepoMetadata(self, repo):
+        """ Keep the metadata of a repo that is going away in case its URL
+            is used again.  Must be called with _yum_lock held.
+        """
+        metadataCache.store(self._repoMetadataURL(repo), {"repo": repo.cachedir})
+
+    def _restoreRepoMetadata(self, repo):
+        """ Reuse the metadata kept for the repo's URL if its repomd.xml has
+            not changed.  yum then finds the downloaded files and the sqlite
+            databases made from them in place and checks them against the
+            new repomd.xml as usual.  Must be called with _yum_lock held.
+        """
+        metadataCache.restore(self._repoMetadataURL(repo), {"repo": repo.cachedir},
+                              repomd=os.path.join(repo.cachedir, "repomd.xml"))
+
     def _removeYumRepo(self, repo_id):
         if repo_id in self.repos:
             with _yum_lock:
+                self._stashRepoMetadata(self._yum.repos.getRepo(repo_id))
                 self._yum.repos.delete(repo_id)
                 self._groups = None
                 self._packages = []
@@ -1397,11 +1541,7 @@ reposdir=%s
             It monitors the status of the install and logs debug info, updates
             the progress meter and cleans up when it is done.
         """
-        progress_map = {
-            "PROGRESS_PREP"    : _("Preparing transaction from installation source"),
-            "PROGRESS_INSTALL" : _("Installing"),
-            "PROGRESS_POST"    : _("Performing post-installation setup tasks")
-        }
+        from pyanaconda.threads import threadMgr, AnacondaThread
 
         ts_file = ROOT_PATH+"/anaconda-yum.yumtx"
         with _yum_lock:
@@ -1417,23 +1557,33 @@ reposdir=%s
         script_log = "/tmp/rpm-script.log"
         release = self._getReleaseVersion(None)
 
+        # anaconda-yum inherits the write end of the pipe and sends progress
+        # records over it, see pyanaconda.yumprogress
+        progress_r, progress_w = os.pipe()
+        fcntl.fcntl(progress_r, fcntl.F_SETFD, fcntl.FD_CLOEXEC)
+
         args = ["--config", "/tmp/anaconda-yum.conf",
                 "--tsfile", ts_file,
                 "--rpmlog", script_log,
                 "--installroot", ROOT_PATH,
                 "--release", release,
-                "--arch", blivet.arch.getArch()]
+                "--arch", blivet.arch.getArch(),
+                "--progress-fd", str(progress_w),
+                "--download-ahead", str(DOWNLOAD_AHEAD)]
+
+        report = TransactionReport()
+        done = threading.Event()
+        threadMgr.add(AnacondaThread(name=THREAD_INSTALL_PROGRESS,
+                                     target=self._readInstallProgress,
+                                     args=(ProgressReader(progress_r), report, done)))
 
         log.info("Running anaconda-yum to install packages")
-        # Watch output for progress, debug and error information
+        # Watch output for debug and error information
         install_errors = []
         try:
             for line in execReadlines("/usr/libexec/anaconda/anaconda-yum", args):
                 if line.startswith("PROGRESS_"):
-                    key, text = line.split(":", 2)
-                    msg = progress_map[key] + text
-                    progressQ.send_message(msg)
-                    log.debug(msg)
+                    log.debug(line)
                 elif line.startswith("DEBUG:"):
                     log.debug(line[6:])
                 elif line.startswith("INFO:"):
@@ -1452,6 +1602,13 @@ reposdir=%s
                 progressQ.send_quit(1)
                 sys.exit(1)
         finally:
+            # anaconda-yum is done, let the reader drain the pipe
+            os.close(progress_w)
+            done.set()
+            threadMgr.wait(THREAD_INSTALL_PROGRESS)
+            os.close(progress_r)
+            self._writeInstallReport(report)
+
             # log the contents of the scriptlet logfile if any
             if os.path.exists(script_log):
                 log.info("==== start rpm scriptlet logs ====")
@@ -1467,6 +1624,51 @@ reposdir=%s
                 progressQ.send_quit(1)
                 sys.exit(1)
 
+    def _readInstallProgress(self, reader, report, done):
+        """ Turn the progress records of anaconda-yum into progress messages
+            and timings until it is done.
+        """
+        while not reader.eof:
+            records = reader.read()
+            for rec_type, rec_time, fields in records:
+                report.handle(rec_type, rec_time, fields)
+
+                if rec_type == REC_PREPARE:
+                    progressQ.send_message(_("Preparing transaction from installation source"))
+                elif rec_type == REC_PACKAGE_START:
+                    # the percentage and the bar are weighted by the installed size
+                    msg = _("Installing") + " %s (%d/%d, %d%%)" % \
+                          (fields[0], report.started, report.packages, report.fraction * 100)
+                    progressQ.send_message(msg)
+                    progressQ.send_fraction(report.fraction)
+                    log.debug(msg)
+                elif rec_type == REC_PACKAGE_BYTES:
+                    # keep the bar moving through large packages
+                    progressQ.send_fraction(report.fraction)
+                elif rec_type == REC_POST:
+                    progressQ.send_message(_("Performing post-installation setup tasks"))
+
+            # Something else may still hold the pipe open, don't wait for
+            # the end of it once anaconda-yum has exited.
+            if not records and done.is_set():
+                break
+
+    def _writeInstallReport(self, report):
+        """ Log the packages that took the longest and write the timing of
+            all of them to INSTALL_REPORT.
+        """
+        slowest = report.slowest(10)
+        if not slowest:
+            return
+
+        log.info("slowest packages: %s",
+                 ", ".join("%s %.1fs (%.1fs in scriptlets)" % (t.name, t.total_time, t.script_time)
+                           for t in slowest))
+        try:
+            report.write(INSTALL_REPORT)
+        except IOError as e:
+            log.error("failed to write %s: %s", INSTALL_REPORT, e.strerror)
+
     def writeMultiLibConfig(self):
         if not self.data.packages.multiLib:
             return
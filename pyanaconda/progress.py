@@ -24,6 +24,7 @@ log = logging.getLogger("anaconda")
 from contextlib import contextmanager
 
 from pyanaconda.queue import QueueFactory
+from pyanaconda.trace import tracer, CAT_PROGRESS
 
 # A queue to be used for communicating progress information between a subthread
 # doing all the hard work and the main thread that does the GTK updates.  This
@@ -39,6 +40,7 @@ progressQ.addMessage("step", 0)
 progressQ.addMessage("message", 1)          # message
 progressQ.addMessage("complete", 0)
 progressQ.addMessage("quit", 1)             # exit_code
+progressQ.addMessage("fraction", 1)         # how much of the current step is done, 0.0 to 1.0
 
 # Surround a block of code with progress updating.  Before the code runs, the
 # message is updated so the user can tell what's about to take so long.
@@ -47,5 +49,6 @@ progressQ.addMessage("quit", 1)             # exit_code
 def progress_report(message):
     progressQ.send_message(message)
     log.info(message)
-    yield
+    with tracer.span(message, CAT_PROGRESS):
+        yield
     progressQ.send_step()
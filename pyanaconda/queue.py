@@ -19,6 +19,9 @@
 # Author(s): Chris Lumens <clumens@redhat.com>
 
 import Queue
+import fcntl
+import os
+import threading
 from pyanaconda.iutil import lowerASCII, upperASCII
 
 class QueueFactory(object):
@@ -41,15 +44,72 @@ class QueueFactory(object):
        that takes one argument.
 
        Reusing names within the same class is not allowed.
+
+       Consumers that would rather be told about new messages than poll for
+       them can register a callback with add_listener, or watch the file
+       descriptor returned by get_wakeup_fd from a main loop.
     """
     def __init__(self, name):
         self.name = name
 
         self.__counter = 0
         self.__names = []
+        self.__listeners = []
+
+        # A pipe that has a byte waiting in it while there are messages the
+        # consumer has not been woken up for.
+        self.__wakeupLock = threading.Lock()
+        self.__wakeupPipe = None
+        self.__wakeupPending = False
 
         self.q = Queue.Queue()
 
+    def get_wakeup_fd(self):
+        """Return a file descriptor that becomes readable when a message is
+           sent, suitable for GLib.io_add_watch.  However many messages are
+           sent, there is only one wakeup until clear_wakeup is called, so
+           call that before taking the messages out of the queue.
+
+           If there are messages in the queue already, the descriptor is
+           readable right away.
+        """
+        with self.__wakeupLock:
+            if self.__wakeupPipe is None:
+                self.__wakeupPipe = os.pipe()
+                for fd in self.__wakeupPipe:
+                    fcntl.fcntl(fd, fcntl.F_SETFD, fcntl.fcntl(fd, fcntl.F_GETFD) | fcntl.FD_CLOEXEC)
+
+            if not self.q.empty():
+                self.__signal_wakeup()
+
+        return self.__wakeupPipe[0]
+
+    def clear_wakeup(self):
+        """Acknowledge a wakeup from the descriptor returned by get_wakeup_fd."""
+        with self.__wakeupLock:
+            if self.__wakeupPending:
+                os.read(self.__wakeupPipe[0], 1)
+                self.__wakeupPending = False
+
+    def __signal_wakeup(self):
+        # must be called with __wakeupLock held
+        if self.__wakeupPipe is not None and not self.__wakeupPending:
+            os.write(self.__wakeupPipe[1], "\0")
+            self.__wakeupPending = True
+
+    def add_listener(self, cb):
+        """Call cb with no arguments every time a message is sent.
+
+           The callback runs in the thread that sent the message, so it should
+           do nothing more than schedule the real work, e.g. with GLib.idle_add.
+        """
+        if cb not in self.__listeners:
+            self.__listeners.append(cb)
+
+    def remove_listener(self, cb):
+        if cb in self.__listeners:
+            self.__listeners.remove(cb)
+
     def _makeMethod(self, constant, methodName, argc):
         def __method(*args):
             if len(args) != argc:
@@ -58,6 +118,12 @@ class QueueFactory(object):
 
             self.q.put((constant, args))
 
+            with self.__wakeupLock:
+                self.__signal_wakeup()
+
+            for listener in self.__listeners[:]:
+                listener()
+
         __method.__name__ = methodName
         return __method
 
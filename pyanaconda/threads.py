@@ -23,6 +23,11 @@ import logging
 log = logging.getLogger("anaconda")
 
 import threading
+import time
+import multiprocessing
+from collections import OrderedDict
+
+from pyanaconda.trace import tracer, CAT_THREAD
 
 _WORKER_THREAD_PREFIX = "AnaWorkerThread"
 
@@ -223,7 +228,8 @@ class AnacondaThread(threading.Thread):
 
         log.info("Running Thread: %s (%s)", self.name, self.ident)
         try:
-            threading.Thread.run(self, *args, **kwargs)
+            with tracer.span(self.name, CAT_THREAD):
+                threading.Thread.run(self, *args, **kwargs)
         # pylint: disable-msg=W0702
         except:
             threadMgr.set_error(self.name, *sys.exc_info())
@@ -233,6 +239,167 @@ class AnacondaThread(threading.Thread):
             threadMgr.remove(self.name)
             log.info("Thread Done: %s (%s)", self.name, self.ident)
 
+# resource classes a TaskGraph task may declare
+RESOURCE_CPU = "cpu"
+RESOURCE_DISK = "disk"
+RESOURCE_NETWORK = "network"
+
+class TaskGraph(object):
+    """A set of named tasks run in AnacondaThreads, each one as soon as the
+       tasks it requires are done and its resource classes have room for it.
+
+       All of the threads are added to threadMgr under the task names when
+       run() is called and hold themselves back until they are allowed to
+       start, so a threadMgr.wait() on a task that is still waiting for its
+       requirements waits for it as well.
+
+       Requirements that are not part of the graph are ignored, which lets
+       the caller leave out tasks that do not apply to the installation
+       without rewriting the requirements of the others.
+    """
+
+    # how many tasks of each resource class may run at the same time
+    resource_limits = {RESOURCE_CPU: multiprocessing.cpu_count(),
+                       RESOURCE_DISK: 1,
+                       RESOURCE_NETWORK: 4}
+
+    def __init__(self, name, resource_limits=None):
+        """:param str name: name of the graph, used in the log
+           :param dict resource_limits: limits to use instead of the default
+                                        ones for some of the resource classes
+        """
+        self.name = name
+        self._tasks = OrderedDict()
+        self._threads = {}
+        self._failed = set()
+        self._lock = threading.Lock()
+        self._remaining = 0
+        self._start_time = None
+        # task name -> (ready, start, end) relative to self._start_time
+        self._times = {}
+        limits = dict(self.resource_limits)
+        limits.update(resource_limits or {})
+        self._semaphores = dict((resource, threading.Semaphore(limit))
+                                for resource, limit in limits.items())
+
+    def add(self, name, target, args=(), requires=(), resources=(), fatal=True):
+        """Add a task to the graph.
+
+           :param str name: name of the task and of its thread, usually one
+                            of the THREAD_* constants
+           :param target: the function to run
+           :param tuple args: arguments for target
+           :param requires: names of the tasks that have to be done before
+                            this one starts
+           :param resources: resource classes (RESOURCE_*) the task uses
+           :param bool fatal: passed on to AnacondaThread
+        """
+        if name in self._tasks:
+            raise KeyError("Task '%s' is already part of the %s graph" % (name, self.name))
+
+        for resource in resources:
+            if resource not in self._semaphores:
+                raise ValueError("Unknown resource class '%s'" % resource)
+
+        # The resource classes are taken one after another, holding the ones
+        # already taken.  Take the caller's own classes (like the one for a
+        # single host) first and the shared RESOURCE_* ones last, so that a
+        # task waiting for a narrow class does not sit on a shared slot that
+        # other tasks could be using.
+        resources = sorted(resources, key=lambda resource: resource in TaskGraph.resource_limits)
+
+        self._tasks[name] = (target, tuple(args), tuple(requires), tuple(resources), fatal)
+
+    def _requirements(self, name):
+        return [req for req in self._tasks[name][2] if req in self._tasks]
+
+    def _check_cycles(self):
+        done = set()
+
+        def visit(name, path):
+            if name in path:
+                raise ValueError("Tasks of the %s graph require each other: %s" %
+                                 (self.name, " -> ".join(path + [name])))
+            if name in done:
+                return
+            for req in self._requirements(name):
+                visit(req, path + [name])
+            done.add(name)
+
+        for name in self._tasks:
+            visit(name, [])
+
+    def run(self):
+        """Start all of the tasks.  This returns right away; use threadMgr
+           to wait for the tasks that need to be finished.
+        """
+        self._check_cycles()
+
+        self._start_time = time.time()
+        self._remaining = len(self._tasks)
+        for name, (target, args, _requires, resources, fatal) in self._tasks.items():
+            self._threads[name] = AnacondaThread(name=name, target=self._run_task,
+                                                 args=(name, target, args, resources),
+                                                 fatal=fatal)
+
+        for name in self._tasks:
+            threadMgr.add(self._threads[name])
+
+    def _run_task(self, name, target, args, resources):
+        failed = True
+        try:
+            for req in self._requirements(name):
+                self._threads[req].join()
+                if req in self._failed:
+                    raise RuntimeError("Task %s requires %s, which failed" % (name, req))
+
+            ready = time.time() - self._start_time
+            for resource in resources:
+                self._semaphores[resource].acquire()
+            try:
+                start = time.time() - self._start_time
+                target(*args)
+                failed = False
+            finally:
+                for resource in resources:
+                    self._semaphores[resource].release()
+                end = time.time() - self._start_time
+                with self._lock:
+                    self._times[name] = (ready, start, end)
+        finally:
+            with self._lock:
+                if failed:
+                    self._failed.add(name)
+                self._remaining -= 1
+                last = self._remaining == 0
+
+            if last:
+                self._log_critical_path()
+
+    def _log_critical_path(self):
+        """Log the chain of tasks that determined how long the whole graph
+           took: start at the task that finished last and repeatedly go to
+           the requirement that finished last.
+        """
+        if not self._times:
+            return
+
+        name = max(self._times, key=lambda n: self._times[n][2])
+        total = self._times[name][2]
+        path = []
+        while name:
+            ready, start, end = self._times[name]
+            if start - ready > 0.01:
+                path.append("%s (%.2f-%.2f s, %.2f s waiting for resources)" % (name, start, end, start - ready))
+            else:
+                path.append("%s (%.2f-%.2f s)" % (name, start, end))
+
+            reqs = [req for req in self._requirements(name) if req in self._times]
+            name = max(reqs, key=lambda n: self._times[n][2]) if reqs else None
+
+        log.info("%s tasks done in %.2f s, critical path: %s",
+                 self.name, total, " <- ".join(path))
+
 def initThreading():
     """Set up threading for anaconda's use. This method must be called before
        any GTK or threading code is called, or else threads will only run when
@@ -0,0 +1,171 @@
+#
+# trace.py:  timeline tracing of anaconda's phases, progress steps and threads
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Lightweight timeline tracing.
+
+   Events are written to TRACE_FILE in the Chrome trace event format as
+   they happen.  The file is a JSON array that is never closed, which the
+   format explicitly allows, so it stays loadable in chrome://tracing or
+   Perfetto even if anaconda dies half way through the installation.
+"""
+
+import os
+import json
+import threading
+import time
+from contextlib import contextmanager
+
+TRACE_FILE = "/tmp/anaconda-trace.json"
+
+# event categories
+CAT_PHASE = "phase"
+CAT_PROGRESS = "progress"
+CAT_THREAD = "thread"
+
+def _process_start_time():
+    """Return the time this process was started at as seconds since the
+       epoch or None if it cannot be found out.
+    """
+    try:
+        with open("/proc/stat") as f:
+            btime = [int(line.split()[1]) for line in f if line.startswith("btime ")][0]
+
+        with open("/proc/self/stat") as f:
+            # the command name may contain spaces, skip past it
+            fields = f.read().rsplit(")", 1)[1].split()
+
+        # starttime is the 22nd field, the 20th one after the command name
+        return btime + float(fields[19]) / os.sysconf("SC_CLK_TCK")
+    except (IOError, IndexError, ValueError, OSError):
+        return None
+
+class Tracer(object):
+    """Writer of trace events.  All of the methods are thread safe.
+
+       Nothing is recorded until start() is called, so the modules using the
+       tracer cost next to nothing outside of the installer.
+    """
+
+    def __init__(self):
+        self._path = None
+        self._file = None
+        self._lock = threading.Lock()
+        self._pid = os.getpid()
+        self._next_tid = 1
+        self._phase = None
+        self.enabled = False
+
+    def start(self, path=TRACE_FILE):
+        """Start recording events to the given file."""
+        with self._lock:
+            self._path = path
+            self.enabled = True
+
+    def _open(self):
+        # called with self._lock held
+        try:
+            self._file = open(self._path, "w")
+        except IOError:
+            self.enabled = False
+            return False
+
+        self._file.write("[\n")
+        self._write({"name": "process_name", "ph": "M", "pid": self._pid,
+                     "args": {"name": "anaconda"}})
+
+        # everything that happened before anyone started tracing
+        started = _process_start_time()
+        if started is not None:
+            self._write({"name": "process startup", "cat": CAT_PHASE, "ph": "X",
+                         "pid": self._pid, "tid": self._tid(threading.current_thread()),
+                         "ts": int(started * 1e6),
+                         "dur": int(max(time.time() - started, 0) * 1e6)})
+        return True
+
+    def _tid(self, thread):
+        # called with self._lock held
+        # Thread idents are reused, so give every thread a small id of its
+        # own and name it the first time it shows up.
+        tid = getattr(thread, "_trace_tid", None)
+        if tid is None:
+            tid = thread._trace_tid = self._next_tid
+            self._next_tid += 1
+            self._write({"name": "thread_name", "ph": "M", "pid": self._pid,
+                         "tid": tid, "args": {"name": thread.name}})
+        return tid
+
+    def _write(self, event):
+        self._file.write(json.dumps(event) + ",\n")
+
+    def _emit(self, event):
+        if not self.enabled:
+            return
+
+        with self._lock:
+            if self._file is None and not self._open():
+                return
+
+            event["pid"] = self._pid
+            event["tid"] = self._tid(threading.current_thread())
+            try:
+                self._write(event)
+                self._file.flush()
+            except IOError:
+                self.enabled = False
+
+    @contextmanager
+    def span(self, name, category=CAT_PHASE, **args):
+        """Record the time spent in the surrounded block of code."""
+        start = time.time()
+        try:
+            yield
+        finally:
+            event = {"name": name, "cat": category, "ph": "X",
+                     "ts": int(start * 1e6), "dur": int((time.time() - start) * 1e6)}
+            if args:
+                event["args"] = args
+            self._emit(event)
+
+    def phase(self, name):
+        """End the current phase and start a new one.  Phases are meant for
+           the long stretch of straight line code in the main thread of the
+           anaconda script, where a with statement does not fit.  A phase
+           that is never ended lasts until the end of the trace.
+        """
+        self.end_phase()
+        self._phase = name
+        self._emit({"name": name, "cat": CAT_PHASE, "ph": "B", "ts": int(time.time() * 1e6)})
+
+    def end_phase(self):
+        """End the current phase, if any."""
+        if self._phase is None:
+            return
+
+        self._emit({"name": self._phase, "cat": CAT_PHASE, "ph": "E", "ts": int(time.time() * 1e6)})
+        self._phase = None
+
+    def instant(self, name, category=CAT_PHASE, **args):
+        """Record a single point in time, like the first hub being shown."""
+        event = {"name": name, "cat": category, "ph": "i", "s": "p",
+                 "ts": int(time.time() * 1e6)}
+        if args:
+            event["args"] = args
+        self._emit(event)
+
+tracer = Tracer()
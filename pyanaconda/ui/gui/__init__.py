@@ -21,7 +21,7 @@
 import inspect, os, sys, time, site
 import meh.ui.gui
 
-from gi.repository import Gdk, Gtk, AnacondaWidgets, Keybinder
+from gi.repository import Gdk, Gtk, Gio, GLib, AnacondaWidgets, Keybinder
 
 from pyanaconda.i18n import _
 from pyanaconda import product
@@ -41,6 +41,48 @@ SCREENSHOT_DELAY = 1  # in seconds
 
 ANACONDA_WINDOW_GROUP = Gtk.WindowGroup()
 
+# The UI definitions and stylesheet are bundled into a single resource file,
+# see anaconda.gresource.xml.
+UI_RESOURCE_FILE = "/usr/share/anaconda/anaconda.gresource"
+UI_RESOURCE_PREFIX = "/org/fedoraproject/anaconda"
+UI_UPDATES_DIRS = ["/tmp/updates", "/run/install/updates"]
+
+_uiResourceRegistered = None
+
+# UI definitions already read from disk, keyed by path.  Dialogs are created
+# anew every time they are shown, so this saves finding and reading the same
+# file over and over.
+_uiDefinitions = {}
+
+def registerUIResource():
+    """Register the bundled UI definitions and stylesheet, if they should be
+       used.  Only the first call does anything.  Return whether the bundle
+       was registered.
+
+       Updates and product images replace the files the bundle was built from,
+       so if one is in use, or UIPATH says where to look, the loose files are
+       used instead.  The same goes for the pixmaps built into the widgets.
+    """
+    global _uiResourceRegistered
+
+    if _uiResourceRegistered is not None:
+        return _uiResourceRegistered
+
+    _uiResourceRegistered = False
+
+    if "UIPATH" in os.environ or any(os.path.exists(d) for d in UI_UPDATES_DIRS):
+        log.info("not using %s, UI files may have been updated", UI_RESOURCE_FILE)
+        os.environ.setdefault("ANACONDA_WIDGETS_DATA", "/usr/share/anaconda")
+    elif os.path.exists(UI_RESOURCE_FILE):
+        try:
+            Gio.resources_register(Gio.Resource.load(UI_RESOURCE_FILE))
+            _uiResourceRegistered = True
+        except GLib.GError as e:
+            log.error("failed to load %s: %s", UI_RESOURCE_FILE, e)
+
+    return _uiResourceRegistered
+
+
 class GUIObject(common.UIObject):
     """This is the base class from which all other GUI classes are derived.  It
        thus contains only attributes and methods that are common to everything
@@ -78,8 +120,9 @@ class GUIObject(common.UIObject):
     screenshots_directory = "/tmp/anaconda-screenshots"
 
     def __init__(self, data):
-        """Create a new UIObject instance, including loading its uiFile and
-           all UI-related objects.
+        """Create a new UIObject instance.  Its uiFile and all UI-related
+           objects are loaded the first time the builder or window attribute
+           is used.
 
            Instance attributes:
 
@@ -107,22 +150,65 @@ class GUIObject(common.UIObject):
         self.skipTo = None
         self.applyOnSkip = False
 
-        self.builder = Gtk.Builder()
-        self.builder.set_translation_domain("anaconda")
+        # The UI is built the first time the builder is needed, so objects
+        # that are never displayed never pay for it.
+        self._builder = None
         self._window = None
 
-        if self.builderObjects:
-            self.builder.add_objects_from_file(self._findUIFile(), self.builderObjects)
+    @property
+    def builder(self):
+        """The Gtk.Builder holding this object's widgets, loaded from uiFile
+           the first time it is accessed.
+        """
+        if not self._builder:
+            self._loadUI()
+
+        return self._builder
+
+    def _loadUI(self):
+        self._builder = Gtk.Builder()
+        self._builder.set_translation_domain("anaconda")
+
+        uiResource = self._findUIResource()
+        if uiResource and self.builderObjects:
+            self._builder.add_objects_from_resource(uiResource, self.builderObjects)
+        elif uiResource:
+            self._builder.add_from_resource(uiResource)
         else:
-            self.builder.add_from_file(self._findUIFile())
+            uiFile = self._findUIFile()
+            definition = _uiDefinitions.get(uiFile)
+            if definition is None:
+                with open(uiFile) as f:
+                    definition = _uiDefinitions.setdefault(uiFile, f.read())
+
+            if self.builderObjects:
+                self._builder.add_objects_from_string(definition, self.builderObjects)
+            else:
+                self._builder.add_from_string(definition)
 
         ANACONDA_WINDOW_GROUP.add_window(self.window)
-        self.builder.connect_signals(self)
+        self._builder.connect_signals(self)
 
         # Keybinder from GI needs to be initialized before use
         Keybinder.init()
         Keybinder.bind("<Shift>Print", self._handlePrntScreen, [])
 
+    def _findUIResource(self):
+        """Return the path of this object's UI definition within the bundled
+           resources, or None if it has to be loaded from a file.
+        """
+        if not registerUIResource():
+            return None
+
+        path = "%s/ui/%s" % (UI_RESOURCE_PREFIX, self.uiFile)
+        try:
+            Gio.resources_get_info(path, Gio.ResourceLookupFlags.NONE)
+        except GLib.GError:
+            # e.g. an addon's spoke, which ships its own UI file
+            return None
+
+        return path
+
     def _findUIFile(self):
         path = os.environ.get("UIPATH", "./:/tmp/updates/:/tmp/updates/ui/:/usr/share/anaconda/ui/")
         dirs = path.split(":")
@@ -370,7 +456,10 @@ class GraphicalUserInterface(UserInterface):
 
         # Apply the application stylesheet
         provider = Gtk.CssProvider()
-        provider.load_from_path("/usr/share/anaconda/anaconda-gtk.css")
+        if registerUIResource():
+            provider.load_from_file(Gio.File.new_for_uri("resource://%s/anaconda-gtk.css" % UI_RESOURCE_PREFIX))
+        else:
+            provider.load_from_path("/usr/share/anaconda/anaconda-gtk.css")
         Gtk.StyleContext.add_provider_for_screen(Gdk.Screen.get_default(), provider,
                 Gtk.STYLE_PROVIDER_PRIORITY_APPLICATION)
 
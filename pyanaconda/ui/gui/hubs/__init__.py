@@ -20,6 +20,7 @@
 #
 
 import os
+import threading
 
 from gi.repository import GLib
 
@@ -33,6 +34,7 @@ from pyanaconda.ui.gui.categories import collect_categories
 from pyanaconda.ui.gui.spokes import StandaloneSpoke, collect_spokes
 from pyanaconda.ui.gui.utils import gtk_call_once, escape_markup
 from pyanaconda.constants import ANACONDA_ENVIRON
+from pyanaconda.trace import tracer
 
 import logging
 log = logging.getLogger("anaconda")
@@ -96,9 +98,27 @@ class Hub(GUIObject, common.Hub):
 
         self._checker = None
 
+        # Spokes report their status through hubQ.  Instead of polling the
+        # queue, the hub is woken up when something is sent and then handles
+        # everything that arrived in the meantime in one go.
+        self._update_lock = threading.Lock()
+        self._update_pending = False
+
+        # Indirect spokes that have not been visited yet, see _createBox
+        self._uninitializedSpokes = []
+
+    def _setupSpokeWindow(self, spoke):
+        spoke.window.set_beta(self.window.get_beta())
+        spoke.window.set_property("distribution", distributionText().upper())
+
     def _runSpoke(self, action):
         from gi.repository import Gtk
 
+        if action in self._uninitializedSpokes:
+            self._uninitializedSpokes.remove(action)
+            self._setupSpokeWindow(action)
+            action.initialize()
+
         # This duplicates code in widgets/src/BaseWindow.c, but we want to make sure
         # maximize gets called every time a spoke is displayed to prevent the 25%
         # UI from showing up.
@@ -172,11 +192,9 @@ class Hub(GUIObject, common.Hub):
                 if not any(spokeClass.should_run(environ, self.data) for environ in self._environs):
                     continue
 
-                # Create the new spoke and populate its UI with whatever data.
-                # From here on, this Spoke will always exist.
+                # Create the new spoke.  From here on, this Spoke will always
+                # exist.  Its UI is only built once something needs it.
                 spoke = spokeClass(self.data, self.storage, self.payload, self.instclass)
-                spoke.window.set_beta(self.window.get_beta())
-                spoke.window.set_property("distribution", distributionText().upper())
 
                 # If a spoke is not showable, it is unreachable in the UI.  We
                 # might as well get rid of it.
@@ -197,10 +215,14 @@ class Hub(GUIObject, common.Hub):
                 #
                 # NOTE:  This only makes sense for NormalSpokes.  Other kinds
                 # of spokes do not involve a hub.
+                #
+                # Nothing is shown for indirect spokes until they are visited,
+                # so their UI is not built and populated until then either.
                 if spoke.indirect:
-                    spoke.initialize()
+                    self._uninitializedSpokes.append(spoke)
                     continue
 
+                self._setupSpokeWindow(spoke)
                 spoke.selector = AnacondaWidgets.SpokeSelector(C_("GUI|Spoke", spoke.title),
                         spoke.icon)
 
@@ -303,18 +325,32 @@ class Hub(GUIObject, common.Hub):
 
         self.continueButton.set_sensitive(self.continuePossible)
 
+    def _schedule_update_spokes(self):
+        """Arrange for _update_spokes to run in the main loop.  This is a hubQ
+           listener and can be called from any thread.  However many messages
+           are sent before the main loop gets to it, the update only runs once.
+        """
+        with self._update_lock:
+            if self._update_pending:
+                return
+            self._update_pending = True
+
+        GLib.idle_add(self._update_spokes)
+
     def _update_spokes(self):
         from pyanaconda.ui.communication import hubQ
         import Queue
 
         q = hubQ.q
 
-        if not self._spokes and self.continueButton:
-            # no spokes, move on
-            log.info("no spokes available on %s, continuing automatically", self)
-            gtk_call_once(self.continueButton.emit, "clicked")
+        with self._update_lock:
+            self._update_pending = False
 
         click_continue = False
+        # Status messages are only shown once the queue is empty, so a spoke
+        # that sends a flurry of them only has its selector updated once.
+        status_messages = {}
+
         # Grab all messages that may have appeared since last time this method ran.
         while True:
             try:
@@ -330,6 +366,7 @@ class Hub(GUIObject, common.Hub):
                 continue
 
             if code == hubQ.HUB_CODE_NOT_READY:
+                status_messages.pop(spoke, None)
                 self._updateCompleteness(spoke)
 
                 if spoke not in self._notReadySpokes:
@@ -338,6 +375,7 @@ class Hub(GUIObject, common.Hub):
                 self._updateContinueButton()
                 log.info("spoke is not ready: %s", spoke)
             elif code == hubQ.HUB_CODE_READY:
+                status_messages.pop(spoke, None)
                 self._updateCompleteness(spoke)
 
                 if spoke in self._notReadySpokes:
@@ -366,24 +404,39 @@ class Hub(GUIObject, common.Hub):
                             click_continue = True
 
             elif code == hubQ.HUB_CODE_MESSAGE:
-                spoke.selector.set_property("status", args[1])
+                status_messages[spoke] = args[1]
                 log.info("setting %s status to: %s", spoke, args[1])
 
             q.task_done()
 
+        for (spoke, status) in status_messages.iteritems():
+            if spoke.selector and spoke.selector.get_property("status") != status:
+                spoke.selector.set_property("status", status)
+
         # queue is now empty, should continue be clicked?
         if self._autoContinue and click_continue and self.continueButton:
             # enqueue the emit to the Gtk message queue
             log.info("_autoContinue clicking continue button")
             gtk_call_once(self.continueButton.emit, "clicked")
 
-        return True
+        return False
 
     def refresh(self):
+        from pyanaconda.ui.communication import hubQ
+
         GUIObject.refresh(self)
         self._createBox()
+        tracer.instant("%s shown" % self.__class__.__name__)
+
+        if not self._spokes and self.continueButton:
+            # no spokes, move on
+            log.info("no spokes available on %s, continuing automatically", self)
+            gtk_call_once(self.continueButton.emit, "clicked")
 
-        GLib.timeout_add(100, self._update_spokes)
+        # Pick up anything sent while the spokes were being created, then
+        # wait to be told about new messages.
+        hubQ.add_listener(self._schedule_update_spokes)
+        self._schedule_update_spokes()
 
     @property
     def continueButton(self):
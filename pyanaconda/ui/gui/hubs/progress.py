@@ -50,6 +50,7 @@ class ProgressHub(Hub):
 
         self._totalSteps = 0
         self._currentStep = 0
+        self._stepFraction = 0.0
         self._configurationDone = False
 
         self._rnotes_id = None
@@ -70,7 +71,7 @@ class ProgressHub(Hub):
 
         self._restart_spinner()
 
-        GLib.timeout_add(250, self._update_progress, self._configuration_done)
+        self._watch_progress(self._configuration_done)
         threadMgr.add(AnacondaThread(name=THREAD_CONFIGURATION, target=doConfiguration,
                                      args=(self.storage, self.payload, self.data, self.instclass)))
 
@@ -80,11 +81,28 @@ class ProgressHub(Hub):
         self._cycle_rnotes()
         self._rnotes_id = GLib.timeout_add_seconds(60, self._cycle_rnotes)
 
+    def _watch_progress(self, callback = None):
+        """Run _update_progress whenever something is sent to progressQ,
+           until it says it is done.
+        """
+        from pyanaconda.progress import progressQ
+
+        GLib.io_add_watch(progressQ.get_wakeup_fd(), GLib.IOCondition.IN,
+                          lambda fd, condition: self._update_progress(callback))
+
     def _update_progress(self, callback = None):
         from pyanaconda.progress import progressQ
         import Queue
 
         q = progressQ.q
+        progressQ.clear_wakeup()
+
+        # Steps and messages arrive in bursts.  Add up the steps and only show
+        # the last message and fraction once the queue is empty, or before
+        # anything that has to be handled in order with them.
+        steps = 0
+        message = None
+        fraction = None
 
         # Grab all messages may have appeared since last time this method ran.
         while True:
@@ -95,12 +113,27 @@ class ProgressHub(Hub):
             except Queue.Empty:
                 break
 
+            if code == progressQ.PROGRESS_CODE_STEP:
+                steps += 1
+                fraction = None
+                q.task_done()
+                continue
+            elif code == progressQ.PROGRESS_CODE_FRACTION:
+                fraction = args[0]
+                q.task_done()
+                continue
+            elif code == progressQ.PROGRESS_CODE_MESSAGE:
+                message = args[0]
+                q.task_done()
+                continue
+
+            self._show_progress(steps, message, fraction)
+            steps = 0
+            message = None
+            fraction = None
+
             if code == progressQ.PROGRESS_CODE_INIT:
                 self._init_progress_bar(args[0])
-            elif code == progressQ.PROGRESS_CODE_STEP:
-                self._step_progress_bar()
-            elif code == progressQ.PROGRESS_CODE_MESSAGE:
-                self._update_progress_message(args[0])
             elif code == progressQ.PROGRESS_CODE_COMPLETE:
                 # There shouldn't be any more progress bar updates, so return False
                 # to indicate this method should be removed from the idle loop.  Also,
@@ -117,8 +150,18 @@ class ProgressHub(Hub):
 
             q.task_done()
 
+        self._show_progress(steps, message, fraction)
         return True
 
+    def _show_progress(self, steps, message, fraction):
+        if steps:
+            self._step_progress_bar(steps)
+
+        if fraction is not None:
+            self._set_step_fraction(fraction)
+
+        if message is not None:
+            self._update_progress_message(message)
 
     def _configuration_done(self):
         # Configuration done, remove ransom notes timer
@@ -244,7 +287,7 @@ class ProgressHub(Hub):
         Hub.refresh(self)
 
         self._start_ransom_notes()
-        GLib.timeout_add(250, self._update_progress, self._install_done)
+        self._watch_progress(self._install_done)
         threadMgr.add(AnacondaThread(name=THREAD_INSTALL, target=doInstall,
                                      args=(self.storage, self.payload, self.data, self.instclass)))
 
@@ -261,16 +304,28 @@ class ProgressHub(Hub):
     def _init_progress_bar(self, steps):
         self._totalSteps = steps
         self._currentStep = 0
+        self._stepFraction = 0.0
 
         gtk_call_once(self._progressBar.set_fraction, 0.0)
 
-    def _step_progress_bar(self):
+    def _step_progress_bar(self, steps = 1):
         if not self._totalSteps:
             return
 
-        self._currentStep += 1
+        self._currentStep += steps
+        self._stepFraction = 0.0
         gtk_call_once(self._progressBar.set_fraction, self._currentStep/self._totalSteps)
 
+    def _set_step_fraction(self, fraction):
+        # move the bar within the current step, for the long ones like
+        # installing the packages
+        if not self._totalSteps or fraction <= self._stepFraction:
+            return
+
+        self._stepFraction = min(fraction, 1.0)
+        gtk_call_once(self._progressBar.set_fraction,
+                      min((self._currentStep + self._stepFraction)/self._totalSteps, 1.0))
+
     def _update_progress_message(self, message):
         if not self._totalSteps:
             return
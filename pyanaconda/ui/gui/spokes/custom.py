@@ -77,7 +77,7 @@ from pyanaconda.ui.gui.spokes.lib.accordion import selectorFromDevice, Accordion
 from pyanaconda.ui.gui.spokes.lib.refresh import RefreshDialog
 from pyanaconda.ui.gui.spokes.lib.summary import ActionSummaryDialog
 from pyanaconda.ui.gui.utils import setViewportBackground, enlightbox, fancy_set_sensitive, ignoreEscape
-from pyanaconda.ui.gui.utils import really_hide, really_show, fire_gtk_action
+from pyanaconda.ui.gui.utils import really_hide, really_show
 from pyanaconda.ui.gui.categories.system import SystemCategory
 
 from gi.repository import Gdk, Gtk
@@ -296,6 +296,13 @@ def selectedRaidLevel(raidLevelCombo):
 
     return levelASCII
 
+def rootPageKey(root):
+    """Return the key of the accordion page for an existing OS.  Two OSes
+       may have the same name, and resetting the storage makes new Root and
+       device objects, so the key is made of the names of both.
+    """
+    return (root.name, tuple(sorted(d.name for d in root.swaps + root.mounts.values())))
+
 class AddDialog(GUIObject):
     builderObjects = ["addDialog", "mountPointStore", "mountPointCompletion", "mountPointEntryBuffer"]
     mainWidgetName = "addDialog"
@@ -685,6 +692,7 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
         self._error = None
         self._media_disks = []
         self._fs_types = []             # list of supported fstypes
+        self._fsComboFilled = False
         self._free_space = Size(bytes=0)
 
         self._device_disks = []
@@ -834,7 +842,6 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
                             (isinstance(obj, FS) or
                              obj.type in ["biosboot", "prepboot", "swap"]))
             if supported_fs:
-                fire_gtk_action(self._fsCombo.append_text, obj.name)
                 self._fs_types.append(obj.name)
 
     @property
@@ -914,10 +921,19 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
         NormalSpoke.refresh(self)
 
         # Make sure the storage spoke execute method has finished before we
-        # copy the storage instance.
-        for thread_name in [THREAD_EXECUTE_STORAGE, THREAD_STORAGE]:
+        # copy the storage instance, and that initialize has collected the
+        # filesystem types (the hub only initializes this spoke on its first
+        # visit, so that may have just started).
+        for thread_name in [THREAD_EXECUTE_STORAGE, THREAD_STORAGE, THREAD_CUSTOM_STORAGE_INIT]:
             threadMgr.wait(thread_name)
 
+        # The initialization thread cannot fill the combo itself, since it
+        # would wait on the main loop that is waiting on it right here.
+        if not self._fsComboFilled:
+            for fs_type in self._fs_types:
+                self._fsCombo.append_text(fs_type)
+            self._fsComboFilled = True
+
         self.passphrase = self.data.autopart.passphrase
         self._reset_storage()
         self._do_refresh()
@@ -978,19 +994,21 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
         self._initialized = False
         self._clear_current_selector()
 
-        # Make sure we start with a clean slate.
-        self._accordion.removeAllPages()
-
         # Start with buttons disabled, since nothing is selected.
         self._removeButton.set_sensitive(False)
         self._configButton.set_sensitive(False)
 
-        # Now it's time to populate the accordion.
+        # Now it's time to populate the accordion.  Pages and selectors that
+        # are already there are updated in place rather than rebuilt.
         log.debug("ui: devices=%s", [d.name for d in self._devices])
         log.debug("ui: unused=%s", [d.name for d in self.unusedDevices])
         log.debug("ui: new_devices=%s", [d.name for d in self.new_devices])
 
         ui_roots = self.__storage.roots[:]
+        new_root = None
+        # the pages of existing OSes are keyed by rootPageKey, their names
+        # need not be unique
+        page_keys = []
 
         # If we've not yet run autopart, add an instance of CreateNewPage.  This
         # ensures it's only added once.
@@ -998,7 +1016,8 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
             page = CreateNewPage(self.translated_new_install_name,
                                  self.on_create_clicked,
                                  partitionsToReuse=bool(ui_roots))
-            self._accordion.addPage(page, cb=self.on_page_clicked)
+            self._accordion.replacePage(page, cb=self.on_page_clicked)
+            page_keys.append(page.pageTitle)
 
             self._partitionsNotebook.set_current_page(NOTEBOOK_LABEL_PAGE)
             self._whenCreateLabel.set_text(
@@ -1025,38 +1044,38 @@ class CustomPartitioningSpoke(NormalSpoke, StorageChecker):
                            (root.name == self.translated_new_install_name or d.format.exists)]:
                 continue
 
-            page = Page(root.name)
-
+            members = []
             for (mountpoint, device) in root.mounts.iteritems():
                 if device not in self._devices or \
                    not device.disks or \
                    (root.name != self.translated_new_install_name and not device.format.exists):
                     continue
 
-                selector = page.addSelector(device, self.on_selector_clicked,
-                                            mountpoint=mountpoint)
-                selector._root = root
+                members.append((device, mountpoint, root))
 
             for device in root.swaps:
                 if device not in self._devices or \
                    (root.name != self.translated_new_install_name and not device.format.exists):
                     continue
 
-                selector = page.addSelector(device, self.on_selector_clicked)
-                selector._root = root
+                members.append((device, "", root))
 
-            page.show_all()
-            self._accordion.addPage(page, cb=self.on_page_clicked)
+            # the new root is made anew every time, but has the only page
+            # with its title
+            key = root.name if root is new_root else rootPageKey(root)
+            self._accordion.updatePage(root.name, members, self.on_selector_clicked,
+                                       cb=self.on_page_clicked, key=key)
+            page_keys.append(key)
 
         # Anything that doesn't go with an OS we understand?  Put it in the Other box.
         if self.unusedDevices:
-            page = UnknownPage(_("Unknown"))
-
-            for u in sorted(self.unusedDevices, key=lambda d: d.name):
-                page.addSelector(u, self.on_selector_clicked)
+            members = [(u, "", None) for u in sorted(self.unusedDevices, key=lambda d: d.name)]
+            self._accordion.updatePage(_("Unknown"), members, self.on_selector_clicked,
+                                       cb=self.on_page_clicked, pageClass=UnknownPage)
+            page_keys.append(_("Unknown"))
 
-            page.show_all()
-            self._accordion.addPage(page, cb=self.on_page_clicked)
+        # Get rid of pages for anything that went away.
+        self._accordion.removeOtherPages(page_keys)
 
         # And then open the first page by default.  Most of the time, this will
         # be fine since it'll be the new installation page.
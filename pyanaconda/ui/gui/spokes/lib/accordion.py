@@ -62,10 +62,15 @@ def selectorFromDevice(device, selector=None, mountpoint=""):
         selector = MountpointSelector(device.name, str(device.size), mp)
         selector._root = None
     else:
-        selector.props.name = device.name
-        selector.props.size = str(device.size)
-        selector.props.mountpoint = mp
-
+        # Setting any of these reformats the selector's labels, so leave alone
+        # whatever did not change.
+        size = str(device.size)
+        if selector.props.name != device.name:
+            selector.props.name = device.name
+        if selector.props.size != size:
+            selector.props.size = size
+        if selector.props.mountpoint != mp:
+            selector.props.mountpoint = mp
     selector._device = device
     return selector
 
@@ -73,12 +78,19 @@ def selectorFromDevice(device, selector=None, mountpoint=""):
 # stores multiple expanders which are here called Pages.  These Pages correspond to
 # individual installed OSes on the system plus some special ones.  When one Page is
 # expanded, all others are collapsed.
+#
+# Rather than being emptied and refilled, the Accordion can be brought up to date
+# with updatePage and removeOtherPages.  Only the Pages and selectors that changed
+# are touched, and selectors that are no longer needed are kept for reuse.  Those
+# methods find Pages by a key given by the caller, the title by default, since two
+# installed OSes may well have the same name.
 class Accordion(Gtk.Box):
     def __init__(self):
         Gtk.Box.__init__(self, orientation=Gtk.Orientation.VERTICAL, spacing=12)
         self._expanders = []
+        self._spareSelectors = []
 
-    def addPage(self, contents, cb=None):
+    def addPage(self, contents, cb=None, key=None):
         label = Gtk.Label()
         label.set_markup("""<span size='large' weight='bold' fgcolor='black'>%s</span>""" %
                 escape_markup(contents.pageTitle))
@@ -89,6 +101,8 @@ class Accordion(Gtk.Box):
         expander.set_label_widget(label)
         expander.add(contents)
 
+        expander._pageKey = key if key is not None else contents.pageTitle
+
         self.add(expander)
         self._expanders.append(expander)
         expander.connect("activate", self._onExpanded, cb)
@@ -101,6 +115,13 @@ class Accordion(Gtk.Box):
 
         return None
 
+    def _find_by_key(self, key):
+        for e in self._expanders:
+            if e._pageKey == key:
+                return e
+
+        return None
+
     @property
     def allPages(self):
         return [e.get_child() for e in self._expanders]
@@ -126,24 +147,119 @@ class Accordion(Gtk.Box):
     def removePage(self, pageTitle):
         # First, remove the expander from the list of expanders we maintain.
         target = self._find_by_title(pageTitle)
-        if not target:
-            return
+        if target:
+            self._removeExpander(target)
 
+    def _removeExpander(self, target):
         self._expanders.remove(target)
 
         # Then, remove it from the box.
+        self._releasePage(target.get_child())
         self.remove(target)
 
     def removeAllPages(self):
         for e in self._expanders:
+            self._releasePage(e.get_child())
             self.remove(e)
 
         self._expanders = []
 
+    def _releasePage(self, page):
+        # Keep the page's selectors around so updatePage can reuse them.
+        for selector in page.members[:]:
+            page.removeSelector(selector)
+            self._spareSelectors.append(selector)
+
+    def replacePage(self, contents, cb=None, key=None):
+        """Put contents in place of the page with the same key, the title by
+           default, or add it as a new page if there is no such page yet.
+        """
+        if key is None:
+            key = contents.pageTitle
+
+        expander = self._find_by_key(key)
+        if not expander:
+            self.addPage(contents, cb, key)
+            return
+
+        self._releasePage(expander.get_child())
+        expander.remove(expander.get_child())
+        expander.add(contents)
+        expander.show_all()
+
+    def updatePage(self, pageTitle, members, selectorCb, cb=None, pageClass=None, key=None):
+        """Make the page with the given key, pageTitle by default, hold
+           exactly the given members, creating the page if needed.
+
+           members is a list of (device, mountpoint, root) tuples.  Selectors
+           for devices already on the page are updated in place, selectors for
+           devices no longer listed are removed, and selectors for new devices
+           are taken from the spare ones left over by earlier removals before
+           any new ones are created.  Devices are matched by name, since
+           resetting the storage makes new device objects.
+
+           If the existing page is not an instance of pageClass (Page by
+           default), it is replaced with a new one.
+
+           Returns the page.
+        """
+        pageClass = pageClass or Page
+        if key is None:
+            key = pageTitle
+
+        expander = self._find_by_key(key)
+        if expander and type(expander.get_child()) is pageClass:
+            page = expander.get_child()
+        else:
+            page = pageClass(pageTitle)
+            self.replacePage(page, cb, key)
+
+        wanted = set(device.name for (device, _mountpoint, _root) in members)
+        for selector in page.members[:]:
+            if selector._device.name not in wanted:
+                page.removeSelector(selector)
+                self._spareSelectors.append(selector)
+
+        existing = dict((selector._device.name, selector) for selector in page.members)
+        for (device, mountpoint, root) in members:
+            selector = existing.get(device.name)
+            if selector:
+                page.updateSelector(selector, device, mountpoint=mountpoint)
+            else:
+                spare = self._spareSelectors.pop() if self._spareSelectors else None
+                selector = page.addSelector(device, selectorCb, mountpoint=mountpoint,
+                                            selector=spare)
+            selector._root = root
+
+        page.show_all()
+        return page
+
+    def removeOtherPages(self, pageKeys):
+        """Remove every page whose key is not in pageKeys, then put the
+           remaining pages in the same order as pageKeys and collapse them.
+        """
+        for expander in self._expanders[:]:
+            if expander._pageKey not in pageKeys:
+                self._removeExpander(expander)
+
+        order = dict((key, i) for (i, key) in enumerate(pageKeys))
+        self._expanders.sort(key=lambda e: order[e._pageKey])
+        for (i, expander) in enumerate(self._expanders):
+            self.reorder_child(expander, i)
+            expander.set_expanded(False)
+
     def _onExpanded(self, obj, cb=None):
         if cb:
             cb(obj.get_child())
 
+def _disconnectSelector(selector):
+    """Drop the signal handlers a Page connected to a selector, so that the
+       selector can be reused on another page.
+    """
+    for handler in getattr(selector, "_handlers", []):
+        selector.disconnect(handler)
+    selector._handlers = []
+
 # A Page is a box that is stored in an Accordion.  It breaks down all the filesystems that
 # comprise a single installed OS into two categories - Data filesystems and System filesystems.
 # Each filesystem is described by a single MountpointSelector.
@@ -176,11 +292,15 @@ class Page(Gtk.Box):
         label.set_margin_left(24)
         return label
 
-    def addSelector(self, device, cb, mountpoint=""):
-        selector = selectorFromDevice(device, mountpoint=mountpoint)
-        selector.connect("button-press-event", self._onSelectorClicked, cb)
-        selector.connect("key-release-event", self._onSelectorClicked, cb)
-        selector.connect("focus-in-event", self._onSelectorFocusIn, cb)
+    def addSelector(self, device, cb, mountpoint="", selector=None):
+        """Add a selector for device to this page.  If selector is given, that
+           previously removed selector is reused instead of creating a new one.
+        """
+        selector = selectorFromDevice(device, selector=selector, mountpoint=mountpoint)
+        selector.set_chosen(False)
+        selector._handlers = [selector.connect("button-press-event", self._onSelectorClicked, cb),
+                              selector.connect("key-release-event", self._onSelectorClicked, cb),
+                              selector.connect("focus-in-event", self._onSelectorFocusIn, cb)]
         selector.set_margin_bottom(6)
         self.members.append(selector)
 
@@ -191,6 +311,22 @@ class Page(Gtk.Box):
 
         return selector
 
+    def updateSelector(self, selector, device, mountpoint=""):
+        """Update a selector already on this page for a changed device,
+           moving it between the data and system boxes if needed.
+        """
+        oldType = self._mountpointType(selector.props.mountpoint)
+        selectorFromDevice(device, selector=selector, mountpoint=mountpoint)
+        newType = self._mountpointType(selector.props.mountpoint)
+
+        if oldType != newType:
+            if oldType == DATA_DEVICE:
+                self._dataBox.remove(selector)
+                self._systemBox.add(selector)
+            else:
+                self._systemBox.remove(selector)
+                self._dataBox.add(selector)
+
     def removeSelector(self, selector):
         if self._mountpointType(selector.props.mountpoint) == DATA_DEVICE:
             self._dataBox.remove(selector)
@@ -198,6 +334,7 @@ class Page(Gtk.Box):
             self._systemBox.remove(selector)
 
         self.members.remove(selector)
+        _disconnectSelector(selector)
 
     def _mountpointType(self, mountpoint):
         if not mountpoint or mountpoint in ["/", "/boot", "/boot/efi", "/tmp", "/usr", "/var",
@@ -242,19 +379,25 @@ class UnknownPage(Page):
         self.members = []
         self.pageTitle = title
 
-    def addSelector(self, device, cb, mountpoint=""):
-        selector = selectorFromDevice(device, mountpoint=mountpoint)
-        selector.connect("button-press-event", self._onSelectorClicked, cb)
-        selector.connect("key-release-event", self._onSelectorClicked, cb)
+    def addSelector(self, device, cb, mountpoint="", selector=None):
+        selector = selectorFromDevice(device, selector=selector, mountpoint=mountpoint)
+        selector.set_chosen(False)
+        selector._handlers = [selector.connect("button-press-event", self._onSelectorClicked, cb),
+                              selector.connect("key-release-event", self._onSelectorClicked, cb)]
+        selector.set_margin_bottom(0)
 
         self.members.append(selector)
         self.add(selector)
 
         return selector
 
+    def updateSelector(self, selector, device, mountpoint=""):
+        selectorFromDevice(device, selector=selector, mountpoint=mountpoint)
+
     def removeSelector(self, selector):
         self.remove(selector)
         self.members.remove(selector)
+        _disconnectSelector(selector)
 
 # This is a special Page that is displayed when no new installation has been automatically
 # created, and shows the user how to go about doing that.  The intention is that an instance
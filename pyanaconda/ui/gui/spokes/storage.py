@@ -39,7 +39,7 @@
 
 """
 
-from gi.repository import Gdk, GLib, AnacondaWidgets
+from gi.repository import GLib, AnacondaWidgets
 
 from pyanaconda.ui.communication import hubQ
 from pyanaconda.ui.lib.disks import getDisks, isLocalDisk
@@ -251,9 +251,6 @@ class StorageSpoke(NormalSpoke, StorageChecker):
 
         self._previous_autopart = False
 
-        self._last_clicked_overview = None
-        self._cur_clicked_overview = None
-
         self._grabObjects()
 
     def _grabObjects(self):
@@ -386,71 +383,9 @@ class StorageSpoke(NormalSpoke, StorageChecker):
         return msg
 
     @property
-    def localOverviews(self):
-        return self.local_disks_box.get_children()
-
-    @property
-    def advancedOverviews(self):
-        return filter(lambda child: isinstance(child, AnacondaWidgets.DiskOverview),
-                      self.specialized_disks_box.get_children())
-
-    def _on_disk_clicked(self, overview, event):
-        # This handler only runs for these two kinds of events, and only for
-        # activate-type keys (space, enter) in the latter event's case.
-        if not event.type in [Gdk.EventType.BUTTON_PRESS, Gdk.EventType.KEY_RELEASE]:
-            return
-
-        if event.type == Gdk.EventType.KEY_RELEASE and \
-           event.keyval not in [Gdk.KEY_space, Gdk.KEY_Return, Gdk.KEY_ISO_Enter, Gdk.KEY_KP_Enter, Gdk.KEY_KP_Space]:
-            return
-
-        if event.type == Gdk.EventType.BUTTON_PRESS and \
-                event.state & Gdk.ModifierType.SHIFT_MASK:
-            # clicked with Shift held down
-
-            if self._last_clicked_overview is None:
-                # nothing clicked before, cannot apply Shift-click
-                return
-
-            local_overviews = self.localOverviews
-            advanced_overviews = self.advancedOverviews
-
-            # find out which list of overviews the clicked one belongs to
-            if overview in local_overviews:
-                from_overviews = local_overviews
-            elif overview in advanced_overviews:
-                from_overviews = advanced_overviews
-            else:
-                # should never happen, but if it does, no other actions should be done
-                return
-
-            if self._last_clicked_overview in from_overviews:
-                # get index of the last clicked overview
-                last_idx = from_overviews.index(self._last_clicked_overview)
-            else:
-                # overview from the other list clicked before, cannot apply "Shift-click"
-                return
-
-            # get index and state of the clicked overview
-            cur_idx = from_overviews.index(overview)
-            state = self._last_clicked_overview.get_chosen()
-
-            if cur_idx > last_idx:
-                copy_to = from_overviews[last_idx:cur_idx+1]
-            else:
-                copy_to = from_overviews[cur_idx:last_idx]
-
-            # copy the state of the last clicked overview to the ones between it and the
-            # one clicked with the Shift held down
-            for disk_overview in copy_to:
-                disk_overview.set_chosen(state)
-
-        self._update_disk_list()
-        self._update_summary()
-
-    def _on_disk_focus_in(self, overview, event):
-        self._last_clicked_overview = self._cur_clicked_overview
-        self._cur_clicked_overview = overview
+    def _diskRows(self):
+        """The rows of both disk grids, see AnacondaWidgets.DiskGridColumn."""
+        return list(self._local_disks_store) + list(self._specialized_disks_store)
 
     def refresh(self):
         self.disks = getDisks(self.storage.devicetree)
@@ -469,20 +404,20 @@ class StorageSpoke(NormalSpoke, StorageChecker):
 
         self._previous_autopart = self.autopart
 
-        # First, remove all non-button children.
-        for child in self.localOverviews + self.advancedOverviews:
-            child.destroy()
+        # First, forget the disks shown before.
+        self._local_disks_store.clear()
+        self._specialized_disks_store.clear()
 
         # Then deal with local disks, which are really easy.  They need to be
         # handled here instead of refresh to take into account the user pressing
         # the rescan button on custom partitioning.
         for disk in filter(isLocalDisk, self.disks):
-            self._add_disk_overview(disk, self.local_disks_box)
+            self._add_disk(disk, self._local_disks_store)
 
         # Advanced disks are different.  Because there can potentially be a lot
-        # of them, we do not display them in the box by default.  Instead, only
+        # of them, we do not display them in the grid by default.  Instead, only
         # those selected in the filter UI are displayed.  This means refresh
-        # needs to know to create and destroy overviews as appropriate.
+        # needs to know to add and remove them as appropriate.
         for name in self.data.ignoredisk.onlyuse:
             if name not in disk_names:
                 continue
@@ -490,12 +425,7 @@ class StorageSpoke(NormalSpoke, StorageChecker):
             if isLocalDisk(obj):
                 continue
 
-            self._add_disk_overview(obj, self.specialized_disks_box)
-
-        # update the selections in the ui
-        for overview in self.localOverviews + self.advancedOverviews:
-            name = overview.get_property("name")
-            overview.set_chosen(name in self.selected_disks)
+            self._add_disk(obj, self._specialized_disks_store)
 
         self._update_summary()
 
@@ -507,13 +437,17 @@ class StorageSpoke(NormalSpoke, StorageChecker):
     def initialize(self):
         NormalSpoke.initialize(self)
 
-        self.local_disks_box = self.builder.get_object("local_disks_box")
-        self.specialized_disks_box = self.builder.get_object("specialized_disks_box")
+        # The grids only create overviews for the disks scrolled into view,
+        # which keeps the spoke quick with hundreds of LUNs attached.
+        self._local_disks_store = AnacondaWidgets.DiskGrid.new_store()
+        self.builder.get_object("local_disks_grid").set_model(self._local_disks_store)
+        self._specialized_disks_store = AnacondaWidgets.DiskGrid.new_store()
+        self.builder.get_object("specialized_disks_grid").set_model(self._specialized_disks_store)
 
         threadMgr.add(AnacondaThread(name=constants.THREAD_STORAGE_WATCHER,
                       target=self._initialize))
 
-    def _add_disk_overview(self, disk, box):
+    def _add_disk(self, disk, store):
         if disk.removable:
             kind = "drive-removable-media"
         else:
@@ -534,23 +468,15 @@ class StorageSpoke(NormalSpoke, StorageChecker):
 
         free = self.storage.getFreeSpace(disks=[disk])[disk.name][0]
 
-        overview = AnacondaWidgets.DiskOverview(description,
-                                                kind,
-                                                str(disk.size),
-                                                _("%s free") % free,
-                                                disk.name,
-                                                popup=popup_info)
-        box.pack_start(overview, False, False, 0)
-
         # FIXME: this will need to get smarter
         #
         # maybe a little function that resolves each item in onlyuse using
         # udev_resolve_devspec and compares that to the DiskDevice?
-        overview.set_chosen(disk.name in self.selected_disks)
-        overview.connect("button-press-event", self._on_disk_clicked)
-        overview.connect("key-release-event", self._on_disk_clicked)
-        overview.connect("focus-in-event", self._on_disk_focus_in)
-        overview.show_all()
+        chosen = disk.name in self.selected_disks
+
+        # in the order of AnacondaWidgets.DiskGridColumn
+        store.append([description, kind, str(disk.size), _("%s free") % free,
+                      disk.name, popup_info, chosen])
 
     def _initialize(self):
         hubQ.send_message(self.__class__.__name__, _("Probing storage..."))
@@ -610,9 +536,9 @@ class StorageSpoke(NormalSpoke, StorageChecker):
 
     def _update_disk_list(self):
         """ Update self.selected_disks based on the UI. """
-        for overview in self.localOverviews + self.advancedOverviews:
-            selected = overview.get_chosen()
-            name = overview.get_property("name")
+        for row in self._diskRows:
+            selected = row[AnacondaWidgets.DiskGridColumn.CHOSEN]
+            name = row[AnacondaWidgets.DiskGridColumn.NAME]
 
             if selected and name not in self.selected_disks:
                 self.selected_disks.append(name)
@@ -634,10 +560,10 @@ class StorageSpoke(NormalSpoke, StorageChecker):
         self.selected_disks = [d.name for d in dialog.disks]
 
         # update the UI to reflect changes to self.selected_disks
-        for overview in self.localOverviews:
-            name = overview.get_property("name")
+        for row in self._diskRows:
+            name = row[AnacondaWidgets.DiskGridColumn.NAME]
 
-            overview.set_chosen(name in self.selected_disks)
+            row[AnacondaWidgets.DiskGridColumn.CHOSEN] = name in self.selected_disks
 
         self._update_summary()
 
@@ -869,22 +795,7 @@ class StorageSpoke(NormalSpoke, StorageChecker):
 
             dialog.window.destroy()
 
-    def on_disks_key_released(self, box, event):
-        # we want to react only on Ctrl-A being pressed
-        if not bool(event.state & Gdk.ModifierType.CONTROL_MASK) or \
-                (event.keyval not in (Gdk.KEY_a, Gdk.KEY_A)):
-            return
-
-        # select disks in the right box
-        if box is self.local_disks_box:
-            overviews = self.localOverviews
-        elif box is self.specialized_disks_box:
-            overviews = self.advancedOverviews
-        else:
-            # no other box contains disk overviews
-            return
-
-        for overview in overviews:
-            overview.set_chosen(True)
-
+    def on_disks_chosen_changed(self, grid):
+        # clicks, shift-clicks and Ctrl-A are handled by the grid itself
         self._update_disk_list()
+        self._update_summary()
@@ -56,7 +56,8 @@ class WelcomeLanguageSpoke(LangLocaleHandler, StandaloneSpoke):
         StandaloneSpoke.__init__(self, *args, **kwargs)
         LangLocaleHandler.__init__(self)
         self._xklwrapper = keyboard.XklWrapper.get_instance()
-        self._origStrings = {}
+        self._translatables = None
+        self._translatedLang = None
 
     def apply(self):
         (store, itr) = self._localeSelection.get_selected()
@@ -217,50 +218,60 @@ class WelcomeLanguageSpoke(LangLocaleHandler, StandaloneSpoke):
         newItr = store.insert(len(langs_with_translations))
         store.set(newItr, 0, "", 1, "", 2, "", 3, True)
 
+        # The user is most likely to pick one of these, so have their
+        # translations ready by the time they do.
+        localization.preload_translations(locales[1:])
+
         # setup the "best" locale
         localization.setup_locale(locales[0], self.data.lang)
         self._select_locale(self.data.lang.lang)
 
-    def _retranslate_one(self, widgetName):
-        widget = self.builder.get_object(widgetName)
-        if not widget:
-            return
-
-        if not widget in self._origStrings:
-            self._origStrings[widget] = widget.get_label()
-
-        before = self._origStrings[widget]
-        widget.set_label(_(before))
+    def _collect_translatables(self):
+        """Return a list of (setter, original string, substitutions) for
+           everything on this screen that needs retranslating.  The original
+           strings are only read from the widgets once.
+        """
+        translatables = []
 
-    def retranslate(self, lang):
-        # Change the translations on labels and buttons that do not have
-        # substitution text.
+        # Labels and buttons that do not have substitution text.
         for name in ["pickLanguageLabel", "betaWarnTitle", "betaWarnDesc",
                      "quitButton", "continueButton"]:
-            self._retranslate_one(name)
+            widget = self.builder.get_object(name)
+            if widget:
+                translatables.append((widget.set_label, widget.get_label(), None))
 
         # The welcome label is special - it has text that needs to be
         # substituted.
         welcomeLabel = self.builder.get_object("welcomeLabel")
+        translatables.append((welcomeLabel.set_label, welcomeLabel.get_label(),
+                              {"name" : productName.upper(), "version" : productVersion}))
 
-        if not welcomeLabel in self._origStrings:
-            self._origStrings[welcomeLabel] = welcomeLabel.get_label()
+        # The language (filtering) entry's placeholder text
+        languageEntry = self.builder.get_object("languageEntry")
+        translatables.append((languageEntry.set_placeholder_text,
+                              languageEntry.get_placeholder_text(), None))
 
-        before = self._origStrings[welcomeLabel]
-        xlated = _(before) % {"name" : productName.upper(), "version" : productVersion}
-        welcomeLabel.set_label(xlated)
+        return translatables
 
-        # Retranslate the language (filtering) entry's placeholder text
-        languageEntry = self.builder.get_object("languageEntry")
-        if not languageEntry in self._origStrings:
-            self._origStrings[languageEntry] = languageEntry.get_placeholder_text()
+    def retranslate(self, lang):
+        if lang == self._translatedLang:
+            return
 
-        languageEntry.set_placeholder_text(_(self._origStrings[languageEntry]))
+        if self._translatables is None:
+            self._translatables = self._collect_translatables()
+
+        for (setter, orig, substitutions) in self._translatables:
+            if substitutions:
+                setter(_(orig) % substitutions)
+            else:
+                setter(_(orig))
 
         # And of course, don't forget the underlying window.
         self.window.set_property("distribution", distributionText().upper())
         self.window.retranslate(lang)
 
+        self._translatedLang = lang
+
     def refresh(self):
         self._select_locale(self.data.lang.lang)
         self._languageEntry.set_text("")
@@ -27,16 +27,13 @@ from pyanaconda.constants import NOTICEABLE_FREEZE
 from contextlib import contextmanager
 from gi.repository import Gdk, Gtk, GLib, AnacondaWidgets
 import Queue
+import collections
 import time
 import threading
 
 import logging
 log = logging.getLogger("anaconda")
 
-# any better idea how to create a unique, distinguishable object that cannot be
-# confused with anything else?
-TERMINATOR = object()
-
 def gtk_call_once(func, *args):
     """Wrapper for GLib.idle_add call that ensures the func is called
        only once.
@@ -132,6 +129,105 @@ class GtkActionList(object):
 
         self._actions = []
 
+class _BatchMapper(object):
+    """Helper for gtk_batch_map that runs an action on items handed over by
+       another thread, in main loop callbacks that each fit in
+       NOTICEABLE_FREEZE.  The number of items per callback adapts to how long
+       the action takes, and no callback is scheduled while there is nothing
+       to do.
+    """
+
+    def __init__(self, action, args, batch_size):
+        self._action = action
+        self._args = args
+
+        # items waiting for the main loop; guarded by _lock together with the
+        # two flags below
+        self._lock = threading.Lock()
+        self._items = collections.deque()
+        self._finished = False
+        self._scheduled = False
+
+        self.done = threading.Event()
+
+        # how many items to run before checking the clock again; starts at
+        # what the caller suggested and follows the measured cost of an item
+        self._batch_size = max(batch_size, 1)
+        self._item_cost = None
+
+        self.processed = 0
+        self.runs = 0
+        self.busy_time = 0.0
+
+    def _schedule(self):
+        # must be called with _lock held
+        if not self._scheduled:
+            self._scheduled = True
+            GLib.idle_add(self._process)
+
+    def put(self, item):
+        with self._lock:
+            self._items.append(item)
+            self._schedule()
+
+    def finish(self):
+        with self._lock:
+            self._finished = True
+            self._schedule()
+
+    def _take_batch(self):
+        """Return the next batch of items, or None if the main loop should stop
+           calling _process for now.
+        """
+        with self._lock:
+            if self._items:
+                count = min(self._batch_size, len(self._items))
+                return [self._items.popleft() for _i in xrange(count)]
+
+            # Nothing to do.  Either everything has been processed, or put()
+            # schedules a new run when the next item arrives.
+            self._scheduled = False
+            if self._finished:
+                self.done.set()
+
+            return None
+
+    def _process(self):
+        tstamp_start = time.time()
+        tstamp = tstamp_start
+        self.runs += 1
+
+        # process as many batches as user shouldn't notice
+        while tstamp - tstamp_start < NOTICEABLE_FREEZE:
+            batch = self._take_batch()
+            if batch is None:
+                self.busy_time += tstamp - tstamp_start
+                return False
+
+            for action_item in batch:
+                self._action(action_item, *self._args)
+
+            now = time.time()
+            cost = (now - tstamp) / len(batch)
+            self.processed += len(batch)
+            tstamp = now
+
+            # Follow changes in the cost of an item, but not every outlier.
+            if self._item_cost is None:
+                self._item_cost = cost
+            else:
+                self._item_cost = (self._item_cost + cost) / 2
+
+            # Size the next batch to fill what is left of the time slice.
+            remaining = NOTICEABLE_FREEZE - (tstamp - tstamp_start)
+            if self._item_cost > 0:
+                self._batch_size = max(1, int(remaining / self._item_cost))
+
+        # out of time but something may be left, give the main loop a chance
+        # to redraw and run again
+        self.busy_time += tstamp - tstamp_start
+        return True
+
 def gtk_batch_map(action, items, args=(), pre_func=None, batch_size=1):
     """
     Function that maps an action on items in a way that makes the action run in
@@ -151,7 +247,9 @@ def gtk_batch_map(action, items, args=(), pre_func=None, batch_size=1):
     :param pre_func: a function that is mapped on the items before they are
                      passed to the action function
     :type pre_func: item -> action_item
-    :param batch_size: how many items should be processed in one run in the main loop
+    :param batch_size: how many items should be processed in the first run in
+                       the main loop; later runs size their batches based on
+                       how long the action took
     :raise AssertionError: if called from the main thread
     :return: None
 
@@ -159,55 +257,33 @@ def gtk_batch_map(action, items, args=(), pre_func=None, batch_size=1):
 
     assert(not threadMgr.in_main_thread())
 
-    def preprocess(queue):
+    mapper = _BatchMapper(action, args, batch_size)
+
+    def preprocess():
         if pre_func:
             for item in items:
-                queue.put(pre_func(item))
+                mapper.put(pre_func(item))
         else:
             for item in items:
-                queue.put(item)
-
-        queue.put(TERMINATOR)
-
-    def process_one_batch((queue, action, done_event)):
-        tstamp_start = time.time()
-        tstamp = time.time()
-
-        # process as many batches as user shouldn't notice
-        while tstamp - tstamp_start < NOTICEABLE_FREEZE:
-            for _i in xrange(batch_size):
-                try:
-                    action_item = queue.get_nowait()
-                    if action_item is TERMINATOR:
-                        # all items processed, tell we are finished and return
-                        done_event.set()
-                        return False
-                    else:
-                        # run action on the item
-                        action(action_item, *args)
-                except Queue.Empty:
-                    # empty queue, reschedule to run later
-                    return True
-
-            tstamp = time.time()
+                mapper.put(item)
 
-        # out of time but something left, reschedule to run again later
-        return True
-
-    item_queue = Queue.Queue()
-    done_event = threading.Event()
+        mapper.finish()
 
     # we don't want to log the whole list, type and address is enough
     log.debug("Starting applying %s on %s", action, object.__repr__(items))
+    tstamp_start = time.time()
 
     # start a thread putting preprocessed items into the queue
     threadMgr.add(AnacondaThread(prefix="AnaGtkBatchPre",
-                                 target=preprocess,
-                                 args=(item_queue,)))
+                                 target=preprocess))
+
+    mapper.done.wait()
 
-    GLib.idle_add(process_one_batch, (item_queue, action, done_event))
-    done_event.wait()
-    log.debug("Finished applying %s on %s", action, object.__repr__(items))
+    elapsed = time.time() - tstamp_start
+    log.debug("Finished applying %s on %s: %d items in %.2f s (%.1f items/s), "
+              "%.2f s in %d main loop runs", action, object.__repr__(items),
+              mapper.processed, elapsed, mapper.processed / elapsed if elapsed else 0.0,
+              mapper.busy_time, mapper.runs)
 
 def timed_action(delay=300, threshold=750, busy_cursor=True):
     """
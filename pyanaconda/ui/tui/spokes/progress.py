@@ -82,6 +82,9 @@ class ProgressSpoke(StandaloneTUISpoke):
                 # Use _stepped as an indication to if we need a newline before
                 # the next message
                 self._stepped = True
+            elif code == progressQ.PROGRESS_CODE_FRACTION:
+                # Text mode only shows whole steps
+                pass
             elif code == progressQ.PROGRESS_CODE_MESSAGE:
                 # This should already be translated
                 if self._stepped:
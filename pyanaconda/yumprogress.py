@@ -0,0 +1,295 @@
+#
+# yumprogress.py: framed progress records from anaconda-yum to YumPayload
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""The progress channel between anaconda-yum and YumPayload.
+
+   anaconda-yum writes a record for every step of the rpm transaction to a
+   pipe given to it with --progress-fd.  Every record is a frame:
+
+       type     B   one of the REC_* constants
+       time     d   seconds since the epoch
+       length   H   length of the fields that follow
+
+   followed by the fields listed for the type in RECORD_FIELDS, where Q is
+   an unsigned and q a signed 64-bit integer and s a string prefixed with
+   its length as H.  All of it is in network byte order.
+
+   anaconda-yum imports this module, so it must not import anything from
+   anaconda beyond the standard library.
+"""
+
+import errno
+import os
+import select
+import struct
+import time
+
+HEADER = struct.Struct("!BdH")
+_INT = struct.Struct("!Q")
+_SIGNED = struct.Struct("!q")
+_STRLEN = struct.Struct("!H")
+
+# record types
+REC_TRANSACTION = 1     # packages in the transaction, their installed size
+REC_PREPARE = 2         # rpm is preparing the transaction
+REC_PACKAGE_START = 3   # package, its installed size
+REC_PACKAGE_BYTES = 4   # package, bytes unpacked, bytes to unpack
+REC_PACKAGE_END = 5     # package
+REC_SCRIPT_START = 6    # package, scriptlet
+REC_SCRIPT_END = 7      # package, scriptlet, return code
+REC_ERROR = 8           # package or "", message
+REC_POST = 9            # all packages are in, post transaction work runs
+
+RECORD_FIELDS = {REC_TRANSACTION:   "QQ",
+                 REC_PREPARE:       "",
+                 REC_PACKAGE_START: "sQ",
+                 REC_PACKAGE_BYTES: "sQQ",
+                 REC_PACKAGE_END:   "s",
+                 REC_SCRIPT_START:  "ss",
+                 REC_SCRIPT_END:    "ssq",
+                 REC_ERROR:         "ss",
+                 REC_POST:          ""}
+
+def encode(rec_type, *fields):
+    """Return the frame for a record of the given type."""
+    data = []
+    for code, value in zip(RECORD_FIELDS[rec_type], fields):
+        if code == "s":
+            if isinstance(value, unicode):
+                value = value.encode("utf-8")
+            value = str(value)[:0xffff]
+            data.append(_STRLEN.pack(len(value)) + value)
+        elif code == "q":
+            data.append(_SIGNED.pack(value))
+        else:
+            data.append(_INT.pack(value))
+
+    data = "".join(data)
+    return HEADER.pack(rec_type, time.time(), len(data)) + data
+
+def decode(rec_type, data):
+    """Return the fields of a record of the given type."""
+    fields = []
+    offset = 0
+    for code in RECORD_FIELDS.get(rec_type, ""):
+        if code == "s":
+            (length,) = _STRLEN.unpack_from(data, offset)
+            offset += _STRLEN.size
+            fields.append(data[offset:offset + length])
+            offset += length
+        elif code == "q":
+            fields.append(_SIGNED.unpack_from(data, offset)[0])
+            offset += _SIGNED.size
+        else:
+            fields.append(_INT.unpack_from(data, offset)[0])
+            offset += _INT.size
+    return fields
+
+class ProgressWriter(object):
+    """The anaconda-yum end of the channel."""
+
+    # how often to send REC_PACKAGE_BYTES for a package, in seconds
+    BYTES_INTERVAL = 0.1
+
+    def __init__(self, fd):
+        self._fd = fd
+        self._last_bytes = 0
+
+    @property
+    def enabled(self):
+        return self._fd is not None
+
+    def send(self, rec_type, *fields):
+        if self._fd is None:
+            return
+
+        frame = encode(rec_type, *fields)
+        try:
+            while frame:
+                frame = frame[os.write(self._fd, frame):]
+        except OSError as e:
+            if e.errno != errno.EPIPE:
+                raise
+            # nobody is listening any more, go on without progress
+            self._fd = None
+
+    def send_bytes(self, name, done, total):
+        """Send REC_PACKAGE_BYTES, unless one was sent very recently."""
+        now = time.time()
+        if done < total and now - self._last_bytes < self.BYTES_INTERVAL:
+            return
+        self._last_bytes = now
+        self.send(REC_PACKAGE_BYTES, name, done, total)
+
+class ProgressReader(object):
+    """The YumPayload end of the channel."""
+
+    def __init__(self, fd):
+        self._fd = fd
+        self._buf = ""
+        self.eof = False
+
+    def read(self, timeout=0.1):
+        """Wait up to timeout seconds for records and return a list of
+           (type, time, fields) of the complete ones that arrived.
+        """
+        records = []
+        if self.eof:
+            return records
+
+        try:
+            readable = select.select([self._fd], [], [], timeout)[0]
+        except select.error as e:
+            if e.args[0] != errno.EINTR:
+                raise
+            readable = []
+
+        if readable:
+            data = os.read(self._fd, 65536)
+            if not data:
+                self.eof = True
+            self._buf += data
+
+        while len(self._buf) >= HEADER.size:
+            rec_type, rec_time, length = HEADER.unpack_from(self._buf)
+            if len(self._buf) < HEADER.size + length:
+                break
+
+            data = self._buf[HEADER.size:HEADER.size + length]
+            self._buf = self._buf[HEADER.size + length:]
+            records.append((rec_type, rec_time, decode(rec_type, data)))
+
+        return records
+
+class PackageTiming(object):
+    """Where the time went for one package."""
+
+    def __init__(self, name, size):
+        self.name = name
+        self.size = size
+        self.start = None
+        self.end = None
+        # [scriptlet, start, end, return code]
+        self.scripts = []
+        self.errors = []
+
+    @property
+    def script_time(self):
+        return sum(end - start for _script, start, end, _rc in self.scripts if end is not None)
+
+    @property
+    def unpack_time(self):
+        """The time between rpm opening and closing the package, without
+           the scriptlets that ran in that time.
+        """
+        if self.start is None or self.end is None:
+            return 0
+
+        inside = sum(end - start for _script, start, end, _rc in self.scripts
+                     if end is not None and start >= self.start and end <= self.end)
+        return max(self.end - self.start - inside, 0)
+
+    @property
+    def total_time(self):
+        return self.unpack_time + self.script_time
+
+class TransactionReport(object):
+    """Collects the records of a transaction into progress and timings."""
+
+    def __init__(self):
+        self.packages = 0
+        self.total_bytes = 0
+        self.started = 0
+        self.timings = {}
+        self._done_bytes = 0
+        self._current_bytes = {}
+
+    def _timing(self, name, size=0):
+        if name not in self.timings:
+            self.timings[name] = PackageTiming(name, size)
+        return self.timings[name]
+
+    def handle(self, rec_type, rec_time, fields):
+        if rec_type == REC_TRANSACTION:
+            self.packages, self.total_bytes = fields
+        elif rec_type == REC_PACKAGE_START:
+            name, size = fields
+            timing = self._timing(name, size)
+            timing.size = size
+            timing.start = rec_time
+            self.started += 1
+            self._current_bytes[name] = 0
+        elif rec_type == REC_PACKAGE_BYTES:
+            name, done, _total = fields
+            self._current_bytes[name] = done
+        elif rec_type == REC_PACKAGE_END:
+            (name,) = fields
+            timing = self._timing(name)
+            timing.end = rec_time
+            self._current_bytes.pop(name, None)
+            self._done_bytes += timing.size
+        elif rec_type == REC_SCRIPT_START:
+            name, script = fields
+            self._timing(name).scripts.append([script, rec_time, None, None])
+        elif rec_type == REC_SCRIPT_END:
+            name, script, rc = fields
+            for entry in reversed(self._timing(name).scripts):
+                if entry[0] == script and entry[2] is None:
+                    entry[2:] = [rec_time, rc]
+                    break
+        elif rec_type == REC_ERROR:
+            name, message = fields
+            self._timing(name).errors.append(message)
+
+    @property
+    def fraction(self):
+        """How much of the transaction is done, weighted by installed size."""
+        if not self.total_bytes:
+            return float(self.started) / self.packages if self.packages else 0.0
+
+        done = self._done_bytes + sum(self._current_bytes.values())
+        return min(float(done) / self.total_bytes, 1.0)
+
+    def slowest(self, count=10):
+        """Return the count packages that took the longest."""
+        timings = [t for t in self.timings.values() if t.name]
+        return sorted(timings, key=lambda t: t.total_time, reverse=True)[:count]
+
+    def write(self, path):
+        """Write the timing of every package and scriptlet, slowest first."""
+        with open(path, "w") as f:
+            f.write("%10s %10s %10s %12s  %s\n" % ("total s", "unpack s", "scripts s", "size KiB", "package"))
+            for timing in self.slowest(len(self.timings)):
+                f.write("%10.3f %10.3f %10.3f %12d  %s\n" %
+                        (timing.total_time, timing.unpack_time, timing.script_time,
+                         timing.size / 1024, timing.name))
+
+            scripts = [(end - start, script, timing.name or "(transaction)", rc)
+                       for timing in self.timings.values()
+                       for script, start, end, rc in timing.scripts if end is not None]
+            f.write("\n%10s %6s %-16s %s\n" % ("seconds", "rc", "scriptlet", "package"))
+            for duration, script, name, rc in sorted(scripts, reverse=True):
+                f.write("%10.3f %6d %-16s %s\n" % (duration, rc, script, name))
+
+            errors = [(timing.name or "(transaction)", error)
+                      for timing in self.timings.values() for error in timing.errors]
+            if errors:
+                f.write("\nerrors:\n")
+                for name, error in errors:
+                    f.write("%s: %s\n" % (name, error))
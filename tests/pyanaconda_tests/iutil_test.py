@@ -99,6 +99,10 @@ class RunProgramTests(unittest.TestCase):
         # test some lines are returned
         self.assertGreater(len(list(iutil.execReadlines("ls", ["--help"]))), 0)
 
+        # test the lines are stripped and an unterminated last line is returned
+        self.assertEqual(list(iutil.execReadlines("printf", ["  one \\ntwo\\n three"])),
+                         ["one", "two", "three"])
+
         # check that it always returns a generator for both
         # if there is some output and if there isn't any
         self.assertIsInstance(iutil.execReadlines("ls", ["--help"]),
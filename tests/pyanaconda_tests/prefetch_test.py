@@ -0,0 +1,93 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions of
+# the GNU General Public License v.2, or (at your option) any later version.
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY expressed or implied, including the implied warranties of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.  You should have received a copy of the
+# GNU General Public License along with this program; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+# 02110-1301, USA.  Any Red Hat trademarks that are incorporated in the
+# source code or documentation are not subject to the GNU General Public
+# License and may only be used or replicated with the express permission of
+# Red Hat, Inc.
+
+import imp
+import os
+import shutil
+import tempfile
+import threading
+import unittest
+
+top_srcdir = os.environ.get("top_srcdir",
+                            os.path.join(os.path.dirname(__file__), "..", ".."))
+anaconda_yum = imp.load_source("anaconda_yum", os.path.join(top_srcdir, "scripts", "anaconda-yum"))
+
+class FakeRepo(object):
+    urls = ["http://example.com/os/"]
+
+class FakePackage(object):
+    size = 1000
+    repo = FakeRepo()
+
+    def __init__(self, name):
+        self.name = name
+
+class FakeTxmbr(object):
+    def __init__(self, po):
+        self.po = po
+
+class FakeConf(object):
+    def __init__(self, cachedir):
+        self.cachedir = cachedir
+
+class FakeYum(object):
+    def __init__(self, cachedir):
+        self.conf = FakeConf(cachedir)
+        self.downloaded = []
+
+    def downloadPkgs(self, pkgs):
+        self.downloaded.extend(pkgs)
+        return {}
+
+class PackagePrefetcherTests(unittest.TestCase):
+    def setUp(self):
+        self.cachedir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.cachedir)
+
+    def _wait(self, prefetcher, po):
+        result = []
+        thread = threading.Thread(target=lambda: result.append(prefetcher.wait(po)))
+        thread.daemon = True
+        thread.start()
+        thread.join(10)
+        self.assertFalse(thread.is_alive(), "waiting for %s hangs" % po.name)
+        return result[0]
+
+    def out_of_order_test(self):
+        """Test rpm asking for a package beyond the download limit first."""
+        pkgs = [FakePackage(name) for name in "abcd"]
+        yb = FakeYum(self.cachedir)
+        # room for two packages, so a and b use it all up
+        prefetcher = anaconda_yum.PackagePrefetcher(yb, [FakeTxmbr(po) for po in pkgs], 2000)
+        prefetcher.start()
+
+        # like a %pretrans package late in the transaction
+        self.assertFalse(self._wait(prefetcher, pkgs[3]))
+
+        self.assertTrue(self._wait(prefetcher, pkgs[0]))
+        prefetcher.done(pkgs[0])
+        self.assertTrue(self._wait(prefetcher, pkgs[1]))
+        prefetcher.done(pkgs[1])
+        self.assertTrue(self._wait(prefetcher, pkgs[2]))
+        prefetcher.done(pkgs[2])
+        prefetcher.stop()
+
+        # the package rpm got itself is not downloaded again
+        self.assertNotIn(pkgs[3], yb.downloaded)
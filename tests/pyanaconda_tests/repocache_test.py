@@ -0,0 +1,69 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions of
+# the GNU General Public License v.2, or (at your option) any later version.
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY expressed or implied, including the implied warranties of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.  You should have received a copy of the
+# GNU General Public License along with this program; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+# 02110-1301, USA.  Any Red Hat trademarks that are incorporated in the
+# source code or documentation are not subject to the GNU General Public
+# License and may only be used or replicated with the express permission of
+# Red Hat, Inc.
+
+from pyanaconda.packaging.repocache import RepoMetadataCache
+import os
+import shutil
+import tempfile
+import unittest
+
+URL = "http://example.com/os/"
+
+class RepoMetadataCacheTests(unittest.TestCase):
+    def setUp(self):
+        self.tmpdir = tempfile.mkdtemp()
+        self.cache = RepoMetadataCache(os.path.join(self.tmpdir, "cache"))
+        self.cachedir = os.path.join(self.tmpdir, "repo")
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def _write(self, name, contents):
+        if not os.path.isdir(self.cachedir):
+            os.makedirs(self.cachedir)
+        with open(os.path.join(self.cachedir, name), "w") as f:
+            f.write(contents)
+
+    def restore_test(self):
+        """Test getting back the metadata of a repo with the same repomd.xml."""
+        self._write("repomd.xml", "one")
+        self._write("primary.sqlite", "packages")
+        self.cache.store(URL, {"repo": self.cachedir})
+        self.assertFalse(os.path.exists(self.cachedir))
+
+        # yum has downloaded repomd.xml again by the time it is restored
+        self._write("repomd.xml", "one")
+        self.assertTrue(self.cache.restore(URL, {"repo": self.cachedir},
+                                           repomd=os.path.join(self.cachedir, "repomd.xml")))
+        with open(os.path.join(self.cachedir, "primary.sqlite")) as f:
+            self.assertEqual(f.read(), "packages")
+
+        # it is gone from the cache once restored
+        self.assertFalse(self.cache.restore(URL, {"repo": self.cachedir}))
+
+    def outdated_test(self):
+        """Test that metadata with a different repomd.xml is not used."""
+        self._write("repomd.xml", "one")
+        self._write("primary.sqlite", "packages")
+        self.cache.store(URL, {"repo": self.cachedir})
+
+        self._write("repomd.xml", "two")
+        self.assertFalse(self.cache.restore(URL, {"repo": self.cachedir},
+                                            repomd=os.path.join(self.cachedir, "repomd.xml")))
+        self.assertFalse(os.path.exists(os.path.join(self.cachedir, "primary.sqlite")))
+        self.assertFalse(self.cache.restore("http://example.com/other/", {"repo": self.cachedir}))
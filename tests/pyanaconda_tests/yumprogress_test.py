@@ -0,0 +1,64 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2014  Red Hat, Inc.
+#
+# This copyrighted material is made available to anyone wishing to use,
+# modify, copy, or redistribute it subject to the terms and conditions of
+# the GNU General Public License v.2, or (at your option) any later version.
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY expressed or implied, including the implied warranties of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.  You should have received a copy of the
+# GNU General Public License along with this program; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+# 02110-1301, USA.  Any Red Hat trademarks that are incorporated in the
+# source code or documentation are not subject to the GNU General Public
+# License and may only be used or replicated with the express permission of
+# Red Hat, Inc.
+
+from pyanaconda import yumprogress
+from pyanaconda.yumprogress import REC_TRANSACTION, REC_PACKAGE_START, REC_PACKAGE_BYTES, \
+                                   REC_PACKAGE_END, REC_SCRIPT_START, REC_SCRIPT_END
+import os
+import unittest
+
+class YumProgressTests(unittest.TestCase):
+    def channel_test(self):
+        """Test sending records through a pipe."""
+        r, w = os.pipe()
+        writer = yumprogress.ProgressWriter(w)
+        reader = yumprogress.ProgressReader(r)
+
+        writer.send(REC_TRANSACTION, 2, 3000)
+        writer.send(REC_SCRIPT_END, u"bash", "POSTIN", -1)
+        os.close(w)
+
+        records = []
+        while not reader.eof:
+            records.extend(reader.read())
+        os.close(r)
+
+        self.assertEqual([(t, f) for t, _time, f in records],
+                         [(REC_TRANSACTION, [2, 3000]),
+                          (REC_SCRIPT_END, ["bash", "POSTIN", -1])])
+
+    def report_test(self):
+        """Test the progress and timings of a transaction."""
+        report = yumprogress.TransactionReport()
+        report.handle(REC_TRANSACTION, 0.0, [2, 4000])
+        report.handle(REC_PACKAGE_START, 1.0, ["big", 3000])
+        report.handle(REC_PACKAGE_BYTES, 1.5, ["big", 1000, 3000])
+        self.assertAlmostEqual(report.fraction, 0.25)
+
+        report.handle(REC_SCRIPT_START, 2.0, ["big", "POSTIN"])
+        report.handle(REC_SCRIPT_END, 5.0, ["big", "POSTIN", 0])
+        report.handle(REC_PACKAGE_END, 6.0, ["big"])
+        report.handle(REC_PACKAGE_START, 6.0, ["small", 1000])
+        report.handle(REC_PACKAGE_END, 6.5, ["small"])
+        self.assertAlmostEqual(report.fraction, 1.0)
+
+        big, small = report.slowest()
+        self.assertEqual((big.name, small.name), ("big", "small"))
+        self.assertAlmostEqual(big.unpack_time, 2.0)
+        self.assertAlmostEqual(big.script_time, 3.0)
+        self.assertAlmostEqual(small.total_time, 0.5)
@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2014  Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * instperf - resource usage sampler for installations
+ *
+ * Reads /proc directly at a fixed rate and stores the samples in a binary
+ * ring file, so that a long installation never fills up the RAM disk.
+ * Every sample is one system-wide record followed by one record for each
+ * of the processes using the most memory.  instperf-report turns the file
+ * into charts.
+ *
+ * The file is a struct instperf_header followed by header.capacity
+ * records of struct instperf_record.  Record number n (counting from 0
+ * since the start) is stored in slot n % capacity, header.written is the
+ * number of records written so far.  All values are in host byte order.
+ */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#define INSTPERF_MAGIC "INSTPRF1"
+
+#define DEFAULT_OUTPUT    "/tmp/instperf.dat"
+#define DEFAULT_INTERVAL  1000
+#define DEFAULT_PROCESSES 8
+#define DEFAULT_CAPACITY  32768
+
+struct instperf_header {
+    char     magic[8];
+    uint32_t record_size;
+    uint32_t capacity;
+    uint32_t interval_ms;
+    uint32_t clk_tck;
+    uint32_t page_size;
+    uint32_t reserved;
+    uint64_t written;
+};
+
+/* Fields marked "system:" have a different meaning in the system-wide
+ * record, which has pid 0.
+ */
+struct instperf_record {
+    uint64_t time_us;       /* wall clock time of the sample */
+    uint32_t pid;
+    uint32_t sample;        /* records of one sample share this number */
+    char     comm[16];
+    uint64_t cpu_ticks;     /* utime + stime; system: busy time of all CPUs */
+    uint64_t total_ticks;   /* system: total time of all CPUs */
+    uint64_t rss_kb;        /* system: MemTotal - MemAvailable */
+    uint64_t pss_kb;        /* system: used swap */
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t major_faults;
+    uint32_t psi_some;      /* system: memory pressure avg10, in 1/100 % */
+    uint32_t psi_full;
+};
+
+static const char shortopts[] = "o:i:n:s:h";
+static const char *usage = "Usage: instperf [-h] [-o <file>] [-i <ms>] [-n <processes>] [-s <records>]\n";
+
+static const struct option longopts[] = {
+    //{name, no_argument | required_argument | optional_argument, *flag, val}
+    {"output",    required_argument, NULL, 'o'},
+    {"interval",  required_argument, NULL, 'i'},
+    {"processes", required_argument, NULL, 'n'},
+    {"size",      required_argument, NULL, 's'},
+    {"help",      no_argument,       NULL, 'h'},
+    {NULL,        0,                 NULL, 0}
+};
+
+static const char *options_help [][2] = {
+    {"output",    "Ring file to write (default " DEFAULT_OUTPUT ")"},
+    {"interval",  "Sampling interval in milliseconds (default 1000)"},
+    {"processes", "Number of processes to record per sample (default 8)"},
+    {"size",      "Size of the ring in records (default 32768)"},
+    {"help",      "Show this help"},
+    {NULL,        NULL}
+};
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_signal(int signum)
+{
+    stop = 1;
+}
+
+static void show_help()
+{
+    int i;
+
+    printf("%s", usage);
+    for (i = 0; options_help[i][0]; i++)
+        printf("  --%-12s %s\n", options_help[i][0], options_help[i][1]);
+}
+
+/* Read a small file into buf and NUL terminate it.  Returns the length or
+ * -1 if the file cannot be read.  This avoids stdio, most of the files
+ * are read hundreds of times a second.
+ */
+static ssize_t read_file(const char *path, char *buf, size_t size)
+{
+    ssize_t len, total = 0;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    while (total < (ssize_t) size - 1) {
+        len = read(fd, buf + total, size - 1 - total);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            break;
+        total += len;
+    }
+
+    close(fd);
+    buf[total] = '\0';
+    return total;
+}
+
+/* Return the number following "key" at the start of a line in buf, or 0. */
+static uint64_t find_value(const char *buf, const char *key)
+{
+    size_t keylen = strlen(key);
+    const char *line = buf;
+
+    while (line && *line) {
+        if (strncmp(line, key, keylen) == 0)
+            return strtoull(line + keylen, NULL, 10);
+
+        line = strchr(line, '\n');
+        if (line)
+            line++;
+    }
+
+    return 0;
+}
+
+/* Parse "avg10=1.23" out of the given line of a PSI file. */
+static uint32_t parse_psi(const char *buf, const char *kind)
+{
+    const char *line = strstr(buf, kind);
+    const char *avg;
+
+    if (!line || !(avg = strstr(line, "avg10=")))
+        return 0;
+
+    return (uint32_t) (strtod(avg + 6, NULL) * 100 + 0.5);
+}
+
+static void sample_system(struct instperf_record *rec)
+{
+    static char buf[16384];
+    uint64_t values[10] = { 0 }, total = 0, idle;
+    uint64_t mem_total, mem_available, swap_total, swap_free;
+    char *p;
+    int i;
+
+    rec->pid = 0;
+    strncpy(rec->comm, "[system]", sizeof(rec->comm));
+
+    /* cpu  user nice system idle iowait irq softirq steal guest guest_nice */
+    if (read_file("/proc/stat", buf, sizeof(buf)) > 0 && strncmp(buf, "cpu ", 4) == 0) {
+        p = buf + 4;
+        for (i = 0; i < 8; i++)
+            values[i] = strtoull(p, &p, 10);
+
+        for (i = 0; i < 8; i++)
+            total += values[i];
+
+        idle = values[3] + values[4];
+        rec->cpu_ticks = total - idle;
+        rec->total_ticks = total;
+    }
+
+    if (read_file("/proc/meminfo", buf, sizeof(buf)) > 0) {
+        mem_total = find_value(buf, "MemTotal:");
+        mem_available = find_value(buf, "MemAvailable:");
+        if (!mem_available)
+            mem_available = find_value(buf, "MemFree:") + find_value(buf, "Buffers:") +
+                            find_value(buf, "Cached:");
+
+        swap_total = find_value(buf, "SwapTotal:");
+        swap_free = find_value(buf, "SwapFree:");
+
+        rec->rss_kb = mem_total > mem_available ? mem_total - mem_available : 0;
+        rec->pss_kb = swap_total > swap_free ? swap_total - swap_free : 0;
+    }
+
+    if (read_file("/proc/vmstat", buf, sizeof(buf)) > 0) {
+        /* pgpgin and pgpgout are in KiB */
+        rec->read_bytes = find_value(buf, "pgpgin ") * 1024;
+        rec->write_bytes = find_value(buf, "pgpgout ") * 1024;
+        rec->major_faults = find_value(buf, "pgmajfault ");
+    }
+
+    /* only there since Linux 4.20 */
+    if (read_file("/proc/pressure/memory", buf, sizeof(buf)) > 0) {
+        rec->psi_some = parse_psi(buf, "some");
+        rec->psi_full = parse_psi(buf, "full");
+    }
+}
+
+/* Fill in what /proc/<pid>/stat has to say about a process.  Returns the
+ * resident set size in pages, or -1 if the process is gone.
+ */
+static long sample_stat(const char *pid, struct instperf_record *rec)
+{
+    char path[PATH_MAX], buf[1024];
+    char *start, *end, *p;
+    uint64_t fields[22];
+    size_t len;
+    int i;
+
+    snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    if (read_file(path, buf, sizeof(buf)) <= 0)
+        return -1;
+
+    /* the command name is in parentheses and may contain anything */
+    start = strchr(buf, '(');
+    end = strrchr(buf, ')');
+    if (!start || !end || end < start)
+        return -1;
+
+    len = end - start - 1;
+    if (len >= sizeof(rec->comm))
+        len = sizeof(rec->comm) - 1;
+    memcpy(rec->comm, start + 1, len);
+    rec->comm[len] = '\0';
+
+    /* fields[0] is field 3 (state) of proc(5) and is skipped */
+    p = end + 2;
+    while (*p && !isspace(*p))
+        p++;
+
+    for (i = 1; i < 22; i++)
+        fields[i] = strtoull(p, &p, 10);
+
+    rec->major_faults = fields[9];
+    rec->cpu_ticks = fields[11] + fields[12];
+    return (long) fields[21];
+}
+
+static void sample_details(struct instperf_record *rec)
+{
+    char path[PATH_MAX], buf[4096];
+
+    /* cheaper than summing up smaps, only there since Linux 4.14 */
+    snprintf(path, sizeof(path), "/proc/%u/smaps_rollup", rec->pid);
+    if (read_file(path, buf, sizeof(buf)) > 0) {
+        rec->rss_kb = find_value(buf, "Rss:");
+        rec->pss_kb = find_value(buf, "Pss:");
+    }
+
+    snprintf(path, sizeof(path), "/proc/%u/io", rec->pid);
+    if (read_file(path, buf, sizeof(buf)) > 0) {
+        rec->read_bytes = find_value(buf, "read_bytes:");
+        rec->write_bytes = find_value(buf, "write_bytes:");
+    }
+}
+
+/* Find the nprocs processes with the largest RSS and fill in their records.
+ * Returns the number of records filled in.
+ */
+static int sample_processes(struct instperf_record *recs, long *rss, int nprocs, long page_kb)
+{
+    struct instperf_record rec;
+    struct dirent *entry;
+    DIR *dir;
+    long pages;
+    int count = 0, i;
+
+    if (nprocs == 0)
+        return 0;
+
+    dir = opendir("/proc");
+    if (!dir)
+        return 0;
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit(entry->d_name[0]))
+            continue;
+
+        memset(&rec, 0, sizeof(rec));
+        pages = sample_stat(entry->d_name, &rec);
+
+        /* kernel threads have no memory of their own */
+        if (pages <= 0)
+            continue;
+
+        if (count == nprocs && pages <= rss[count - 1])
+            continue;
+
+        /* insert into the list sorted by RSS */
+        i = count < nprocs ? count++ : count - 1;
+        while (i > 0 && rss[i - 1] < pages) {
+            recs[i] = recs[i - 1];
+            rss[i] = rss[i - 1];
+            i--;
+        }
+
+        rec.pid = (uint32_t) strtoul(entry->d_name, NULL, 10);
+        rec.rss_kb = pages * page_kb;
+        recs[i] = rec;
+        rss[i] = pages;
+    }
+
+    closedir(dir);
+
+    for (i = 0; i < count; i++)
+        sample_details(&recs[i]);
+
+    return count;
+}
+
+static void timespec_add_ms(struct timespec *ts, long ms)
+{
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = DEFAULT_OUTPUT;
+    long interval = DEFAULT_INTERVAL, nprocs = DEFAULT_PROCESSES, capacity = DEFAULT_CAPACITY;
+    struct instperf_header *header;
+    struct instperf_record *ring, *recs;
+    struct sigaction sa;
+    struct timespec next;
+    struct timeval now;
+    long *rss, page_kb;
+    size_t size;
+    uint32_t sample = 0;
+    int fd, opt, option_index = 0, count, i;
+
+    while ((opt = getopt_long(argc, argv, shortopts, longopts, &option_index)) != -1) {
+        switch (opt) {
+        case 'o':
+            output = optarg;
+            break;
+        case 'i':
+            interval = strtol(optarg, NULL, 10);
+            break;
+        case 'n':
+            nprocs = strtol(optarg, NULL, 10);
+            break;
+        case 's':
+            capacity = strtol(optarg, NULL, 10);
+            break;
+        case 'h':
+            show_help();
+            exit(EXIT_SUCCESS);
+        default:
+            show_help();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (interval <= 0 || nprocs < 0 || capacity <= nprocs) {
+        fprintf(stderr, "%s", usage);
+        exit(EXIT_FAILURE);
+    }
+
+    size = sizeof(*header) + capacity * sizeof(*ring);
+
+    fd = open(output, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, size) < 0) {
+        perror(output);
+        exit(EXIT_FAILURE);
+    }
+
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    memcpy(header->magic, INSTPERF_MAGIC, sizeof(header->magic));
+    header->record_size = sizeof(*ring);
+    header->capacity = capacity;
+    header->interval_ms = interval;
+    header->clk_tck = sysconf(_SC_CLK_TCK);
+    header->page_size = sysconf(_SC_PAGESIZE);
+    header->written = 0;
+    ring = (struct instperf_record *) (header + 1);
+
+    page_kb = header->page_size / 1024;
+    recs = calloc(nprocs + 1, sizeof(*recs));
+    rss = calloc(nprocs + 1, sizeof(*rss));
+    if (!recs || !rss) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    /* stay out of the way of the installation we are measuring */
+    setpriority(PRIO_PROCESS, 0, 10);
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!stop) {
+        gettimeofday(&now, NULL);
+
+        memset(recs, 0, (nprocs + 1) * sizeof(*recs));
+        sample_system(&recs[0]);
+        count = 1 + sample_processes(recs + 1, rss, nprocs, page_kb);
+
+        for (i = 0; i < count; i++) {
+            recs[i].time_us = (uint64_t) now.tv_sec * 1000000 + now.tv_usec;
+            recs[i].sample = sample;
+            ring[header->written % capacity] = recs[i];
+            header->written++;
+        }
+        sample++;
+
+        /* sleep until the next tick, not for the interval, so the time
+         * spent sampling does not add up
+         */
+        timespec_add_ms(&next, interval);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR && !stop)
+            ;
+    }
+
+    msync(header, size, MS_SYNC);
+    munmap(header, size);
+    free(recs);
+    free(rss);
+
+    return EXIT_SUCCESS;
+}
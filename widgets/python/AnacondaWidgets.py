@@ -84,3 +84,14 @@ class DiskOverview(Anaconda.DiskOverview):
 
 DiskOverview = override(DiskOverview)
 __all__.append('DiskOverview')
+
+class DiskGrid(Anaconda.DiskGrid):
+    def __init__(self, model=None):
+        Anaconda.DiskGrid.__init__(self)
+
+        if model is None:
+            model = Anaconda.DiskGrid.new_store()
+        self.set_model(model)
+
+DiskGrid = override(DiskGrid)
+__all__.append('DiskGrid')
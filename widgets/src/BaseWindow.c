@@ -99,6 +99,9 @@ struct _AnacondaBaseWindowPrivate {
 
     /* Untranslated versions of various things. */
     gchar *orig_name, *orig_distro, *orig_beta;
+
+    /* The language the window was last retranslated to. */
+    gchar *trans_lang;
 };
 
 static void anaconda_base_window_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
@@ -203,6 +206,7 @@ static void anaconda_base_window_init(AnacondaBaseWindow *win) {
     win->priv->orig_name = NULL;
     win->priv->orig_distro = NULL;
     win->priv->orig_beta = NULL;
+    win->priv->trans_lang = NULL;
 
     /* Set properties on the parent (Gtk.Window) class. */
     gtk_window_set_decorated(GTK_WINDOW(win), FALSE);
@@ -585,6 +589,15 @@ void anaconda_base_window_clear_info(AnacondaBaseWindow *win) {
 void anaconda_base_window_retranslate(AnacondaBaseWindow *win, const char *lang) {
     GValue distro = G_VALUE_INIT;
 
+    /* Switching the locale makes gettext drop every catalog it has loaded,
+     * so don't do it if nothing changed.
+     */
+    if (g_strcmp0(win->priv->trans_lang, lang) == 0)
+        return;
+
+    g_free(win->priv->trans_lang);
+    win->priv->trans_lang = g_strdup(lang);
+
     setenv("LANGUAGE", lang, 1);
     setlocale(LC_ALL, "");
 
@@ -0,0 +1,900 @@
+/*
+ * Copyright (C) 2014  Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gdk/gdk.h>
+#include <gdk/gdkkeysyms.h>
+
+#include "DiskGrid.h"
+#include "DiskOverview.h"
+#include "intl.h"
+
+/**
+ * SECTION: DiskGrid
+ * @title: AnacondaDiskGrid
+ * @short_description: A scrolling grid of disks backed by a list model
+ *
+ * A #AnacondaDiskGrid displays one #AnacondaDiskOverview tile for each row of
+ * a #GtkListStore with the columns described by #AnacondaDiskGridColumn.
+ *
+ * Only the tiles that are currently scrolled into view exist.  As the grid is
+ * scrolled, tiles that leave the view are rebound to the rows coming into
+ * view, so the cost of the grid does not depend on the number of disks.
+ *
+ * Choosing disks works the same way as with a box full of overviews: a click
+ * or an activate key toggles a disk, a shift-click copies the state of the
+ * previously focused disk to every disk in between, and Ctrl-A chooses every
+ * disk.  The chosen state is stored in the #ANACONDA_DISK_GRID_COLUMN_CHOSEN
+ * column of the model, and #AnacondaDiskGrid::chosen-changed is emitted
+ * whenever the user changes it.  The arrow keys, Home, End and Tab move the
+ * keyboard focus between disks, scrolling as needed.
+ */
+
+enum {
+    PROP_MODEL = 1
+};
+
+enum {
+    SIGNAL_CHOSEN_CHANGED,
+    LAST_SIGNAL
+};
+
+static guint grid_signals[LAST_SIGNAL] = { 0 };
+
+/* Space between tiles, matching the spacing of the disk boxes in the storage spoke. */
+#define TILE_SPACING    30
+
+/* Key used to store the row index a tile is bound to */
+#define TILE_INDEX_KEY  "anaconda-disk-grid-index"
+
+struct _AnacondaDiskGridPrivate {
+    GtkWidget    *layout;
+    GtkListStore *model;
+
+    /* Tiles currently bound to a row, keyed by row index */
+    GHashTable   *tiles;
+
+    /* Hidden tiles waiting to be bound again */
+    GSList       *spare_tiles;
+
+    gint          n_rows;
+    gint          columns;
+    gint          tile_width;
+    gint          tile_height;
+
+    /* Row indices of the currently and previously focused tiles, or -1 */
+    gint          focus_index;
+    gint          last_focus_index;
+
+    /* Tiles bound to this row index or later may show the wrong row since
+     * rows were inserted, deleted or reordered, or G_MAXINT.  They are fixed
+     * up from an idle handler so that a burst of changes costs one pass.
+     */
+    gint          changed_from;
+    gboolean      focus_changed;
+    guint         rows_changed_idle;
+
+    gulong        row_changed_handler;
+    gulong        row_inserted_handler;
+    gulong        row_deleted_handler;
+    gulong        rows_reordered_handler;
+};
+
+G_DEFINE_TYPE(AnacondaDiskGrid, anaconda_disk_grid, GTK_TYPE_SCROLLED_WINDOW)
+
+static void anaconda_disk_grid_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+static void anaconda_disk_grid_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec);
+static void anaconda_disk_grid_dispose(GObject *object);
+static void anaconda_disk_grid_finalize(GObject *object);
+
+static void anaconda_disk_grid_layout_allocated(GtkWidget *layout, GtkAllocation *allocation, gpointer user_data);
+static void anaconda_disk_grid_scrolled(GtkAdjustment *adjustment, gpointer user_data);
+static void anaconda_disk_grid_relayout(AnacondaDiskGrid *grid);
+static void anaconda_disk_grid_update_tiles(AnacondaDiskGrid *grid);
+static void anaconda_disk_grid_focus_index(AnacondaDiskGrid *grid, gint index);
+
+static void anaconda_disk_grid_row_changed(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data);
+static void anaconda_disk_grid_row_inserted(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data);
+static void anaconda_disk_grid_row_deleted(GtkTreeModel *model, GtkTreePath *path, gpointer user_data);
+static void anaconda_disk_grid_rows_reordered(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer new_order, gpointer user_data);
+static gboolean anaconda_disk_grid_rows_changed_idle(gpointer user_data);
+static void anaconda_disk_grid_rows_changed(AnacondaDiskGrid *grid);
+static void anaconda_disk_grid_flush_rows_changed(AnacondaDiskGrid *grid);
+static void anaconda_disk_grid_queue_rows_changed(AnacondaDiskGrid *grid, gint index);
+
+static gboolean anaconda_disk_grid_tile_clicked(GtkWidget *tile, GdkEvent *event, gpointer user_data);
+static gboolean anaconda_disk_grid_tile_focus_in(GtkWidget *tile, GdkEventFocus *event, gpointer user_data);
+static gboolean anaconda_disk_grid_tile_key_pressed(GtkWidget *tile, GdkEventKey *event, gpointer user_data);
+static gboolean anaconda_disk_grid_key_released(GtkWidget *widget, GdkEventKey *event, gpointer user_data);
+
+static void anaconda_disk_grid_class_init(AnacondaDiskGridClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->set_property = anaconda_disk_grid_set_property;
+    object_class->get_property = anaconda_disk_grid_get_property;
+    object_class->dispose = anaconda_disk_grid_dispose;
+    object_class->finalize = anaconda_disk_grid_finalize;
+
+    /**
+     * AnacondaDiskGrid:model:
+     *
+     * The #GtkListStore holding the disks to display.  It must have the
+     * columns described by #AnacondaDiskGridColumn.
+     *
+     * Since: 2.0
+     */
+    g_object_class_install_property(object_class,
+                                    PROP_MODEL,
+                                    g_param_spec_object("model",
+                                                        P_("Model"),
+                                                        P_("The list of disks to display"),
+                                                        GTK_TYPE_LIST_STORE,
+                                                        G_PARAM_READWRITE));
+
+    /**
+     * AnacondaDiskGrid::chosen-changed:
+     * @grid: the grid that received the signal
+     *
+     * Emitted after the user has chosen or unchosen one or more disks.  The
+     * new state is already stored in the model.
+     *
+     * Since: 2.0
+     */
+    grid_signals[SIGNAL_CHOSEN_CHANGED] = g_signal_new("chosen-changed",
+                                                       G_TYPE_FROM_CLASS(object_class),
+                                                       G_SIGNAL_RUN_FIRST,
+                                                       G_STRUCT_OFFSET(AnacondaDiskGridClass, chosen_changed),
+                                                       NULL, NULL,
+                                                       g_cclosure_marshal_VOID__VOID,
+                                                       G_TYPE_NONE, 0);
+
+    g_type_class_add_private(object_class, sizeof(AnacondaDiskGridPrivate));
+}
+
+/**
+ * anaconda_disk_grid_new:
+ *
+ * Creates a new #AnacondaDiskGrid, which is a scrolling grid of disks.  Use
+ * anaconda_disk_grid_set_model() to give it something to display.
+ *
+ * Returns: A new #AnacondaDiskGrid.
+ */
+GtkWidget *anaconda_disk_grid_new(void) {
+    return g_object_new(ANACONDA_TYPE_DISK_GRID, NULL);
+}
+
+/**
+ * anaconda_disk_grid_new_store:
+ *
+ * Creates an empty #GtkListStore with the columns an #AnacondaDiskGrid
+ * expects, in the order given by #AnacondaDiskGridColumn.
+ *
+ * Returns: (transfer full): A new #GtkListStore.
+ */
+GtkListStore *anaconda_disk_grid_new_store(void) {
+    return gtk_list_store_new(ANACONDA_DISK_GRID_N_COLUMNS,
+                              G_TYPE_STRING,      /* description */
+                              G_TYPE_STRING,      /* kind */
+                              G_TYPE_STRING,      /* capacity */
+                              G_TYPE_STRING,      /* free */
+                              G_TYPE_STRING,      /* name */
+                              G_TYPE_STRING,      /* popup-info */
+                              G_TYPE_BOOLEAN);    /* chosen */
+}
+
+static void anaconda_disk_grid_init(AnacondaDiskGrid *grid) {
+    grid->priv = G_TYPE_INSTANCE_GET_PRIVATE(grid,
+                                             ANACONDA_TYPE_DISK_GRID,
+                                             AnacondaDiskGridPrivate);
+
+    grid->priv->tiles = g_hash_table_new(g_direct_hash, g_direct_equal);
+    grid->priv->columns = 1;
+    grid->priv->focus_index = -1;
+    grid->priv->last_focus_index = -1;
+    grid->priv->changed_from = G_MAXINT;
+
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(grid), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+
+    /* The layout provides the scrollable canvas the tiles are placed on. */
+    grid->priv->layout = gtk_layout_new(NULL, NULL);
+    gtk_widget_set_hexpand(grid->priv->layout, TRUE);
+    gtk_container_add(GTK_CONTAINER(grid), grid->priv->layout);
+    gtk_widget_show(grid->priv->layout);
+
+    g_signal_connect_after(grid->priv->layout, "size-allocate",
+                           G_CALLBACK(anaconda_disk_grid_layout_allocated), grid);
+    g_signal_connect(gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(grid->priv->layout)), "value-changed",
+                     G_CALLBACK(anaconda_disk_grid_scrolled), grid);
+
+    /* Ctrl-A chooses every disk, just like in the storage spoke's disk boxes. */
+    g_signal_connect(grid, "key-release-event", G_CALLBACK(anaconda_disk_grid_key_released), NULL);
+}
+
+static void anaconda_disk_grid_disconnect_model(AnacondaDiskGrid *grid) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+
+    if (!priv->model)
+        return;
+
+    g_signal_handler_disconnect(priv->model, priv->row_changed_handler);
+    g_signal_handler_disconnect(priv->model, priv->row_inserted_handler);
+    g_signal_handler_disconnect(priv->model, priv->row_deleted_handler);
+    g_signal_handler_disconnect(priv->model, priv->rows_reordered_handler);
+    g_object_unref(priv->model);
+    priv->model = NULL;
+}
+
+static void anaconda_disk_grid_dispose(GObject *object) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(object);
+
+    if (grid->priv->rows_changed_idle) {
+        g_source_remove(grid->priv->rows_changed_idle);
+        grid->priv->rows_changed_idle = 0;
+    }
+
+    anaconda_disk_grid_disconnect_model(grid);
+
+    G_OBJECT_CLASS(anaconda_disk_grid_parent_class)->dispose(object);
+}
+
+static void anaconda_disk_grid_finalize(GObject *object) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(object);
+
+    /* The tiles themselves belong to the layout and are gone by now. */
+    g_hash_table_destroy(grid->priv->tiles);
+    g_slist_free(grid->priv->spare_tiles);
+
+    G_OBJECT_CLASS(anaconda_disk_grid_parent_class)->finalize(object);
+}
+
+static void anaconda_disk_grid_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(object);
+
+    switch(prop_id) {
+        case PROP_MODEL:
+            g_value_set_object(value, grid->priv->model);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void anaconda_disk_grid_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(object);
+
+    switch(prop_id) {
+        case PROP_MODEL:
+            anaconda_disk_grid_set_model(grid, g_value_get_object(value));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+/**
+ * anaconda_disk_grid_get_model:
+ * @grid: a #AnacondaDiskGrid
+ *
+ * Returns: (transfer none): The #GtkListStore displayed by @grid, or %NULL.
+ *
+ * Since: 2.0
+ */
+GtkListStore *anaconda_disk_grid_get_model(AnacondaDiskGrid *grid) {
+    g_return_val_if_fail(ANACONDA_IS_DISK_GRID(grid), NULL);
+
+    return grid->priv->model;
+}
+
+/**
+ * anaconda_disk_grid_set_model:
+ * @grid: a #AnacondaDiskGrid
+ * @model: (allow-none): a #GtkListStore created by anaconda_disk_grid_new_store(),
+ *         or %NULL to display nothing.
+ *
+ * Sets the list of disks displayed by @grid.  Changes to @model are picked
+ * up as they happen.
+ *
+ * Since: 2.0
+ */
+void anaconda_disk_grid_set_model(AnacondaDiskGrid *grid, GtkListStore *model) {
+    AnacondaDiskGridPrivate *priv;
+
+    g_return_if_fail(ANACONDA_IS_DISK_GRID(grid));
+
+    priv = grid->priv;
+    if (priv->model == model)
+        return;
+
+    anaconda_disk_grid_disconnect_model(grid);
+
+    if (model) {
+        priv->model = g_object_ref(model);
+        priv->row_changed_handler = g_signal_connect(model, "row-changed",
+                G_CALLBACK(anaconda_disk_grid_row_changed), grid);
+        priv->row_inserted_handler = g_signal_connect(model, "row-inserted",
+                G_CALLBACK(anaconda_disk_grid_row_inserted), grid);
+        priv->row_deleted_handler = g_signal_connect(model, "row-deleted",
+                G_CALLBACK(anaconda_disk_grid_row_deleted), grid);
+        priv->rows_reordered_handler = g_signal_connect(model, "rows-reordered",
+                G_CALLBACK(anaconda_disk_grid_rows_reordered), grid);
+    }
+
+    /* Every tile shows a row of the old model, so rebind them all right away. */
+    if (priv->rows_changed_idle) {
+        g_source_remove(priv->rows_changed_idle);
+        priv->rows_changed_idle = 0;
+    }
+    priv->focus_index = -1;
+    priv->last_focus_index = -1;
+    priv->changed_from = 0;
+    anaconda_disk_grid_rows_changed(grid);
+
+    g_object_notify(G_OBJECT(grid), "model");
+}
+
+/**
+ * anaconda_disk_grid_set_all_chosen:
+ * @grid: a #AnacondaDiskGrid
+ * @is_chosen: %TRUE to choose every disk, %FALSE to unchoose them.
+ *
+ * Sets the chosen state of every disk in the model.
+ *
+ * Since: 2.0
+ */
+void anaconda_disk_grid_set_all_chosen(AnacondaDiskGrid *grid, gboolean is_chosen) {
+    GtkTreeIter iter;
+    gboolean valid;
+
+    g_return_if_fail(ANACONDA_IS_DISK_GRID(grid));
+
+    if (!grid->priv->model)
+        return;
+
+    valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(grid->priv->model), &iter);
+    while (valid) {
+        gtk_list_store_set(grid->priv->model, &iter, ANACONDA_DISK_GRID_COLUMN_CHOSEN, is_chosen, -1);
+        valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(grid->priv->model), &iter);
+    }
+}
+
+/* Copy one row of the model into a tile. */
+static void anaconda_disk_grid_bind_tile(AnacondaDiskGrid *grid, GtkWidget *tile, gint index) {
+    GtkTreeIter iter;
+    gchar *description, *kind, *capacity, *free, *name, *popup_info;
+    gboolean chosen;
+
+    if (!gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(grid->priv->model), &iter, NULL, index))
+        return;
+
+    gtk_tree_model_get(GTK_TREE_MODEL(grid->priv->model), &iter,
+                       ANACONDA_DISK_GRID_COLUMN_DESCRIPTION, &description,
+                       ANACONDA_DISK_GRID_COLUMN_KIND, &kind,
+                       ANACONDA_DISK_GRID_COLUMN_CAPACITY, &capacity,
+                       ANACONDA_DISK_GRID_COLUMN_FREE, &free,
+                       ANACONDA_DISK_GRID_COLUMN_NAME, &name,
+                       ANACONDA_DISK_GRID_COLUMN_POPUP_INFO, &popup_info,
+                       ANACONDA_DISK_GRID_COLUMN_CHOSEN, &chosen,
+                       -1);
+
+    g_object_set_data(G_OBJECT(tile), TILE_INDEX_KEY, GINT_TO_POINTER(index));
+
+    /* Set chosen before kind so the icon is only loaded once. */
+    if (anaconda_disk_overview_get_chosen(ANACONDA_DISK_OVERVIEW(tile)) != chosen)
+        anaconda_disk_overview_set_chosen(ANACONDA_DISK_OVERVIEW(tile), chosen);
+
+    g_object_set(tile,
+                 "description", description ? description : "",
+                 "kind", kind ? kind : "drive-harddisk",
+                 "capacity", capacity ? capacity : "",
+                 "free", free ? free : "",
+                 "name", name ? name : "",
+                 "popup-info", popup_info ? popup_info : "",
+                 NULL);
+
+    gtk_widget_show_all(tile);
+
+    g_free(description);
+    g_free(kind);
+    g_free(capacity);
+    g_free(free);
+    g_free(name);
+    g_free(popup_info);
+}
+
+static gint anaconda_disk_grid_tile_index(GtkWidget *tile) {
+    return GPOINTER_TO_INT(g_object_get_data(G_OBJECT(tile), TILE_INDEX_KEY));
+}
+
+/*
+ * Whether a tile is still bound to the row its index names.  Input on a tile
+ * can arrive before the idle handler has fixed up the tiles after rows moved,
+ * so the handlers fix them up first and ignore tiles that got released.
+ */
+static gboolean anaconda_disk_grid_tile_is_bound(AnacondaDiskGrid *grid, GtkWidget *tile) {
+    anaconda_disk_grid_flush_rows_changed(grid);
+    return g_hash_table_lookup(grid->priv->tiles, GINT_TO_POINTER(anaconda_disk_grid_tile_index(tile))) == tile;
+}
+
+/* Get a tile for a row, reusing a spare one if there is one. */
+static GtkWidget *anaconda_disk_grid_acquire_tile(AnacondaDiskGrid *grid, gint index) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GtkWidget *tile;
+
+    if (priv->spare_tiles) {
+        tile = GTK_WIDGET(priv->spare_tiles->data);
+        priv->spare_tiles = g_slist_delete_link(priv->spare_tiles, priv->spare_tiles);
+    } else {
+        tile = anaconda_disk_overview_new();
+        gtk_layout_put(GTK_LAYOUT(priv->layout), tile, 0, 0);
+
+        /* The overview's own handlers run first and toggle the chosen state. */
+        g_signal_connect(tile, "button-press-event", G_CALLBACK(anaconda_disk_grid_tile_clicked), grid);
+        g_signal_connect(tile, "key-release-event", G_CALLBACK(anaconda_disk_grid_tile_clicked), grid);
+        g_signal_connect(tile, "focus-in-event", G_CALLBACK(anaconda_disk_grid_tile_focus_in), grid);
+        g_signal_connect(tile, "key-press-event", G_CALLBACK(anaconda_disk_grid_tile_key_pressed), grid);
+    }
+
+    anaconda_disk_grid_bind_tile(grid, tile, index);
+    g_hash_table_insert(priv->tiles, GINT_TO_POINTER(index), tile);
+    return tile;
+}
+
+static void anaconda_disk_grid_release_tile(AnacondaDiskGrid *grid, GtkWidget *tile) {
+    gtk_widget_hide(tile);
+    grid->priv->spare_tiles = g_slist_prepend(grid->priv->spare_tiles, tile);
+}
+
+/* Figure out how many columns fit and how tall the canvas needs to be. */
+static void anaconda_disk_grid_relayout(AnacondaDiskGrid *grid) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GtkAllocation allocation;
+    gint rows;
+
+    gtk_widget_get_allocation(priv->layout, &allocation);
+
+    if (priv->tile_width > 0)
+        priv->columns = MAX(1, (allocation.width + TILE_SPACING) / (priv->tile_width + TILE_SPACING));
+
+    rows = (priv->n_rows + priv->columns - 1) / priv->columns;
+    gtk_layout_set_size(GTK_LAYOUT(priv->layout),
+                        MAX(1, allocation.width),
+                        MAX(1, rows * (priv->tile_height + TILE_SPACING)));
+}
+
+/*
+ * Make sure exactly the rows in view have a tile.  Tiles whose rows scrolled
+ * out of view are recycled for the rows that scrolled in.  The focused tile
+ * is kept even when it is out of view so that focus does not jump around.
+ */
+static void anaconda_disk_grid_update_tiles(AnacondaDiskGrid *grid) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GtkAdjustment *vadj;
+    GHashTableIter hash_iter;
+    gpointer key, value;
+    GtkRequisition natural;
+    gint first, last, index, row_height;
+    gint old_width, old_height;
+    GtkWidget *tile;
+
+    if (!priv->model || priv->n_rows == 0)
+        return;
+
+    /* Size every tile like the first one until a bigger one turns up. */
+    if (priv->tile_width == 0) {
+        tile = anaconda_disk_grid_acquire_tile(grid, 0);
+        gtk_widget_get_preferred_size(tile, NULL, &natural);
+        priv->tile_width = MAX(1, natural.width);
+        priv->tile_height = MAX(1, natural.height);
+        anaconda_disk_grid_relayout(grid);
+    }
+
+    row_height = priv->tile_height + TILE_SPACING;
+    vadj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(priv->layout));
+    first = ((gint) gtk_adjustment_get_value(vadj) / row_height) * priv->columns;
+    last = (((gint) (gtk_adjustment_get_value(vadj) + gtk_adjustment_get_page_size(vadj)) / row_height) + 1) * priv->columns;
+    last = MIN(last, priv->n_rows);
+
+    g_hash_table_iter_init(&hash_iter, priv->tiles);
+    while (g_hash_table_iter_next(&hash_iter, &key, &value)) {
+        index = GPOINTER_TO_INT(key);
+        if ((index >= first && index < last) ||
+            (index == priv->focus_index && index < priv->n_rows && gtk_widget_has_focus(GTK_WIDGET(value))))
+            continue;
+
+        anaconda_disk_grid_release_tile(grid, GTK_WIDGET(value));
+        g_hash_table_iter_remove(&hash_iter);
+    }
+
+    old_width = priv->tile_width;
+    old_height = priv->tile_height;
+
+    for (index = first; index < last; index++) {
+        tile = g_hash_table_lookup(priv->tiles, GINT_TO_POINTER(index));
+        if (!tile)
+            tile = anaconda_disk_grid_acquire_tile(grid, index);
+
+        gtk_widget_get_preferred_size(tile, NULL, &natural);
+        priv->tile_width = MAX(priv->tile_width, natural.width);
+        priv->tile_height = MAX(priv->tile_height, natural.height);
+    }
+
+    /* A bigger tile came into view, so everything needs to be spaced out more. */
+    if (priv->tile_width != old_width || priv->tile_height != old_height) {
+        anaconda_disk_grid_relayout(grid);
+        gtk_widget_queue_resize(priv->layout);
+    }
+
+    g_hash_table_iter_init(&hash_iter, priv->tiles);
+    while (g_hash_table_iter_next(&hash_iter, &key, &value)) {
+        index = GPOINTER_TO_INT(key);
+        gtk_widget_set_size_request(GTK_WIDGET(value), priv->tile_width, priv->tile_height);
+        gtk_layout_move(GTK_LAYOUT(priv->layout), GTK_WIDGET(value),
+                        (index % priv->columns) * (priv->tile_width + TILE_SPACING),
+                        (index / priv->columns) * row_height);
+    }
+}
+
+static void anaconda_disk_grid_layout_allocated(GtkWidget *layout, GtkAllocation *allocation, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    gint old_columns = grid->priv->columns;
+
+    /* Moving tiles around by their old rows would only have to be undone. */
+    anaconda_disk_grid_flush_rows_changed(grid);
+    anaconda_disk_grid_relayout(grid);
+
+    /* Only walk the tiles if the width or height in view actually changed something. */
+    if (old_columns != grid->priv->columns || grid->priv->tile_width == 0)
+        anaconda_disk_grid_update_tiles(grid);
+    else
+        anaconda_disk_grid_scrolled(NULL, grid);
+}
+
+static void anaconda_disk_grid_scrolled(GtkAdjustment *adjustment, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+
+    anaconda_disk_grid_flush_rows_changed(grid);
+    anaconda_disk_grid_update_tiles(grid);
+}
+
+/*
+ * Fix up the tiles after rows were inserted, deleted or reordered.  Tiles
+ * for rows before the first change still show the right row and are left
+ * alone.  The focused tile moved along with its row, so it only gets its new
+ * index; rebinding it would hide it and send the focus somewhere else.
+ */
+static void anaconda_disk_grid_rows_changed(AnacondaDiskGrid *grid) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GHashTableIter hash_iter;
+    gpointer key, value;
+    GtkWidget *focus_tile = NULL;
+
+    priv->n_rows = priv->model ? gtk_tree_model_iter_n_children(GTK_TREE_MODEL(priv->model), NULL) : 0;
+    if (priv->focus_index >= priv->n_rows)
+        priv->focus_index = -1;
+    if (priv->last_focus_index >= priv->n_rows)
+        priv->last_focus_index = -1;
+
+    g_hash_table_iter_init(&hash_iter, priv->tiles);
+    while (g_hash_table_iter_next(&hash_iter, &key, &value)) {
+        if (GPOINTER_TO_INT(key) < priv->changed_from)
+            continue;
+
+        if (priv->focus_index >= 0 && gtk_widget_has_focus(GTK_WIDGET(value)))
+            focus_tile = GTK_WIDGET(value);
+        else
+            anaconda_disk_grid_release_tile(grid, GTK_WIDGET(value));
+        g_hash_table_iter_remove(&hash_iter);
+    }
+
+    if (focus_tile) {
+        g_object_set_data(G_OBJECT(focus_tile), TILE_INDEX_KEY, GINT_TO_POINTER(priv->focus_index));
+        g_hash_table_insert(priv->tiles, GINT_TO_POINTER(priv->focus_index), focus_tile);
+
+        /* Its row was also changed while it was moving. */
+        if (priv->focus_changed)
+            anaconda_disk_grid_bind_tile(grid, focus_tile, priv->focus_index);
+    }
+
+    priv->changed_from = G_MAXINT;
+    priv->focus_changed = FALSE;
+
+    /* Only the rows in view that have no tile now get one bound. */
+    anaconda_disk_grid_relayout(grid);
+    anaconda_disk_grid_update_tiles(grid);
+}
+
+static gboolean anaconda_disk_grid_rows_changed_idle(gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+
+    grid->priv->rows_changed_idle = 0;
+    anaconda_disk_grid_rows_changed(grid);
+    return FALSE;
+}
+
+/* Fix up the tiles now if they are waiting for the idle handler. */
+static void anaconda_disk_grid_flush_rows_changed(AnacondaDiskGrid *grid) {
+    if (!grid->priv->rows_changed_idle)
+        return;
+
+    g_source_remove(grid->priv->rows_changed_idle);
+    grid->priv->rows_changed_idle = 0;
+    anaconda_disk_grid_rows_changed(grid);
+}
+
+/* Note that the rows from index on have moved and schedule fixing up the tiles. */
+static void anaconda_disk_grid_queue_rows_changed(AnacondaDiskGrid *grid, gint index) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+
+    priv->changed_from = MIN(priv->changed_from, index);
+    if (!priv->rows_changed_idle)
+        priv->rows_changed_idle = g_idle_add_full(GDK_PRIORITY_REDRAW,
+                                                  anaconda_disk_grid_rows_changed_idle,
+                                                  grid, NULL);
+}
+
+/*
+ * The focus indices are kept in step with the model right away, so that they
+ * name the same rows once the tiles are fixed up.
+ */
+static void anaconda_disk_grid_row_inserted(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint index;
+
+    index = gtk_tree_path_get_indices(path)[0];
+    if (priv->focus_index >= index)
+        priv->focus_index++;
+    if (priv->last_focus_index >= index)
+        priv->last_focus_index++;
+
+    anaconda_disk_grid_queue_rows_changed(grid, index);
+}
+
+static void anaconda_disk_grid_row_deleted(GtkTreeModel *model, GtkTreePath *path, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint index;
+
+    index = gtk_tree_path_get_indices(path)[0];
+    if (priv->focus_index == index)
+        priv->focus_index = -1;
+    else if (priv->focus_index > index)
+        priv->focus_index--;
+    if (priv->last_focus_index == index)
+        priv->last_focus_index = -1;
+    else if (priv->last_focus_index > index)
+        priv->last_focus_index--;
+
+    anaconda_disk_grid_queue_rows_changed(grid, index);
+}
+
+static void anaconda_disk_grid_rows_reordered(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer new_order, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint *order = new_order;
+    gint n_rows, index, focus_index = -1, last_focus_index = -1;
+
+    /* new_order[new position] is the old position of each row */
+    n_rows = gtk_tree_model_iter_n_children(model, NULL);
+    for (index = 0; index < n_rows; index++) {
+        if (order[index] == priv->focus_index)
+            focus_index = index;
+        if (order[index] == priv->last_focus_index)
+            last_focus_index = index;
+    }
+    priv->focus_index = focus_index;
+    priv->last_focus_index = last_focus_index;
+
+    anaconda_disk_grid_queue_rows_changed(grid, 0);
+}
+
+static void anaconda_disk_grid_row_changed(GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GtkWidget *tile;
+    gint index;
+
+    index = gtk_tree_path_get_indices(path)[0];
+
+    /* The tiles from changed_from on are keyed by their old rows until the
+     * idle handler runs, and it binds all of them except the focused one.
+     */
+    if (index >= priv->changed_from) {
+        if (index == priv->focus_index)
+            priv->focus_changed = TRUE;
+        return;
+    }
+
+    /* Rows that are not in view will be bound when they scroll in. */
+    tile = g_hash_table_lookup(priv->tiles, GINT_TO_POINTER(index));
+    if (tile)
+        anaconda_disk_grid_bind_tile(grid, tile, index);
+}
+
+static void anaconda_disk_grid_set_chosen(AnacondaDiskGrid *grid, gint index, gboolean is_chosen) {
+    GtkTreeIter iter;
+
+    if (gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(grid->priv->model), &iter, NULL, index))
+        gtk_list_store_set(grid->priv->model, &iter, ANACONDA_DISK_GRID_COLUMN_CHOSEN, is_chosen, -1);
+}
+
+static gboolean anaconda_disk_grid_get_chosen(AnacondaDiskGrid *grid, gint index) {
+    GtkTreeIter iter;
+    gboolean chosen = FALSE;
+
+    if (gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(grid->priv->model), &iter, NULL, index))
+        gtk_tree_model_get(GTK_TREE_MODEL(grid->priv->model), &iter, ANACONDA_DISK_GRID_COLUMN_CHOSEN, &chosen, -1);
+
+    return chosen;
+}
+
+/*
+ * The overview has already toggled itself by the time this runs, so store
+ * its new state in the model and handle shift-click.
+ */
+static gboolean anaconda_disk_grid_tile_clicked(GtkWidget *tile, GdkEvent *event, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint index, first, last;
+    gboolean state;
+
+    if (event->type != GDK_BUTTON_PRESS && event->type != GDK_KEY_RELEASE)
+        return FALSE;
+    else if (event->type == GDK_KEY_RELEASE &&
+        (event->key.keyval != GDK_KEY_space && event->key.keyval != GDK_KEY_Return &&
+         event->key.keyval != GDK_KEY_ISO_Enter && event->key.keyval != GDK_KEY_KP_Enter &&
+         event->key.keyval != GDK_KEY_KP_Space))
+        return FALSE;
+
+    if (!anaconda_disk_grid_tile_is_bound(grid, tile))
+        return FALSE;
+
+    index = anaconda_disk_grid_tile_index(tile);
+    anaconda_disk_grid_set_chosen(grid, index, anaconda_disk_overview_get_chosen(ANACONDA_DISK_OVERVIEW(tile)));
+
+    /* Copy the state of the previously focused disk to every disk between it
+     * and the one clicked with Shift held down.
+     */
+    if (event->type == GDK_BUTTON_PRESS && (event->button.state & GDK_SHIFT_MASK) &&
+        priv->last_focus_index >= 0) {
+        state = anaconda_disk_grid_get_chosen(grid, priv->last_focus_index);
+
+        if (index > priv->last_focus_index) {
+            first = priv->last_focus_index;
+            last = index + 1;
+        } else {
+            first = index;
+            last = priv->last_focus_index;
+        }
+
+        for (; first < last; first++)
+            anaconda_disk_grid_set_chosen(grid, first, state);
+    }
+
+    g_signal_emit(grid, grid_signals[SIGNAL_CHOSEN_CHANGED], 0);
+    return FALSE;
+}
+
+static gboolean anaconda_disk_grid_tile_focus_in(GtkWidget *tile, GdkEventFocus *event, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint last_focus_index = priv->focus_index;
+
+    /* The tile named by focus_index has lost the focus to this one, so do not
+     * let fixing up the tiles mistake this one for it.
+     */
+    priv->focus_index = -1;
+    if (anaconda_disk_grid_tile_is_bound(grid, tile))
+        priv->focus_index = anaconda_disk_grid_tile_index(tile);
+
+    priv->last_focus_index = last_focus_index;
+    return FALSE;
+}
+
+/* Scroll a row into view and give its tile the keyboard focus. */
+static void anaconda_disk_grid_focus_index(AnacondaDiskGrid *grid, gint index) {
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    GtkAdjustment *vadj;
+    GtkWidget *tile;
+    gdouble top, bottom;
+
+    vadj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(priv->layout));
+    top = (index / priv->columns) * (priv->tile_height + TILE_SPACING);
+    bottom = top + priv->tile_height;
+
+    if (top < gtk_adjustment_get_value(vadj))
+        gtk_adjustment_set_value(vadj, top);
+    else if (bottom > gtk_adjustment_get_value(vadj) + gtk_adjustment_get_page_size(vadj))
+        gtk_adjustment_set_value(vadj, bottom - gtk_adjustment_get_page_size(vadj));
+
+    /* Setting the adjustment value runs update_tiles, but the row may have been in view already. */
+    tile = g_hash_table_lookup(priv->tiles, GINT_TO_POINTER(index));
+    if (!tile) {
+        anaconda_disk_grid_update_tiles(grid);
+        tile = g_hash_table_lookup(priv->tiles, GINT_TO_POINTER(index));
+    }
+
+    if (tile)
+        gtk_widget_grab_focus(tile);
+}
+
+static gboolean anaconda_disk_grid_tile_key_pressed(GtkWidget *tile, GdkEventKey *event, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(user_data);
+    AnacondaDiskGridPrivate *priv = grid->priv;
+    gint index, target;
+
+    if (!anaconda_disk_grid_tile_is_bound(grid, tile))
+        return FALSE;
+
+    index = anaconda_disk_grid_tile_index(tile);
+
+    switch (event->keyval) {
+        case GDK_KEY_Left:
+        case GDK_KEY_KP_Left:
+            target = index - 1;
+            break;
+        case GDK_KEY_Right:
+        case GDK_KEY_KP_Right:
+            target = index + 1;
+            break;
+        case GDK_KEY_Up:
+        case GDK_KEY_KP_Up:
+            target = index - priv->columns;
+            break;
+        case GDK_KEY_Down:
+        case GDK_KEY_KP_Down:
+            target = index + priv->columns;
+            break;
+        case GDK_KEY_Home:
+        case GDK_KEY_KP_Home:
+            target = 0;
+            break;
+        case GDK_KEY_End:
+        case GDK_KEY_KP_End:
+            target = priv->n_rows - 1;
+            break;
+        case GDK_KEY_Tab:
+        case GDK_KEY_ISO_Left_Tab:
+            /* Tabbing off either end of the grid leaves it, as it did with a box of overviews. */
+            if (event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK))
+                return FALSE;
+            target = (event->state & GDK_SHIFT_MASK || event->keyval == GDK_KEY_ISO_Left_Tab) ? index - 1 : index + 1;
+            if (target < 0 || target >= priv->n_rows)
+                return FALSE;
+            break;
+        default:
+            return FALSE;
+    }
+
+    if (target >= 0 && target < priv->n_rows && target != index)
+        anaconda_disk_grid_focus_index(grid, target);
+
+    return TRUE;
+}
+
+static gboolean anaconda_disk_grid_key_released(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
+    AnacondaDiskGrid *grid = ANACONDA_DISK_GRID(widget);
+
+    /* we want to react only on Ctrl-A being pressed */
+    if (!(event->state & GDK_CONTROL_MASK) || (event->keyval != GDK_KEY_a && event->keyval != GDK_KEY_A))
+        return FALSE;
+
+    anaconda_disk_grid_set_all_chosen(grid, TRUE);
+    g_signal_emit(grid, grid_signals[SIGNAL_CHOSEN_CHANGED], 0);
+    return TRUE;
+}
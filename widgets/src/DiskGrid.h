@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2014  Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DISK_GRID_H
+#define _DISK_GRID_H
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define ANACONDA_TYPE_DISK_GRID            (anaconda_disk_grid_get_type())
+#define ANACONDA_DISK_GRID(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), ANACONDA_TYPE_DISK_GRID, AnacondaDiskGrid))
+#define ANACONDA_IS_DISK_GRID(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), ANACONDA_TYPE_DISK_GRID))
+#define ANACONDA_DISK_GRID_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), ANACONDA_TYPE_DISK_GRID, AnacondaDiskGridClass))
+#define ANACONDA_IS_DISK_GRID_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), ANACONDA_TYPE_DISK_GRID))
+#define ANACONDA_DISK_GRID_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), ANACONDA_TYPE_DISK_GRID, AnacondaDiskGridClass))
+
+typedef struct _AnacondaDiskGrid         AnacondaDiskGrid;
+typedef struct _AnacondaDiskGridClass    AnacondaDiskGridClass;
+typedef struct _AnacondaDiskGridPrivate  AnacondaDiskGridPrivate;
+
+/**
+ * AnacondaDiskGridColumn:
+ * @ANACONDA_DISK_GRID_COLUMN_DESCRIPTION: the #AnacondaDiskOverview:description string
+ * @ANACONDA_DISK_GRID_COLUMN_KIND: the #AnacondaDiskOverview:kind string
+ * @ANACONDA_DISK_GRID_COLUMN_CAPACITY: the #AnacondaDiskOverview:capacity string
+ * @ANACONDA_DISK_GRID_COLUMN_FREE: the #AnacondaDiskOverview:free string
+ * @ANACONDA_DISK_GRID_COLUMN_NAME: the #AnacondaDiskOverview:name string
+ * @ANACONDA_DISK_GRID_COLUMN_POPUP_INFO: the #AnacondaDiskOverview:popup-info string
+ * @ANACONDA_DISK_GRID_COLUMN_CHOSEN: whether the disk is chosen, as a boolean
+ * @ANACONDA_DISK_GRID_N_COLUMNS: the number of columns in the model
+ *
+ * The columns of the #GtkListStore displayed by an #AnacondaDiskGrid.  Use
+ * anaconda_disk_grid_new_store() to create a store with these columns.
+ */
+typedef enum {
+    ANACONDA_DISK_GRID_COLUMN_DESCRIPTION,
+    ANACONDA_DISK_GRID_COLUMN_KIND,
+    ANACONDA_DISK_GRID_COLUMN_CAPACITY,
+    ANACONDA_DISK_GRID_COLUMN_FREE,
+    ANACONDA_DISK_GRID_COLUMN_NAME,
+    ANACONDA_DISK_GRID_COLUMN_POPUP_INFO,
+    ANACONDA_DISK_GRID_COLUMN_CHOSEN,
+    ANACONDA_DISK_GRID_N_COLUMNS
+} AnacondaDiskGridColumn;
+
+/**
+ * AnacondaDiskGrid:
+ *
+ * The AnacondaDiskGrid struct contains only private fields and should not
+ * be directly accessed.
+ */
+struct _AnacondaDiskGrid {
+    GtkScrolledWindow        parent;
+
+    /*< private >*/
+    AnacondaDiskGridPrivate *priv;
+};
+
+/**
+ * AnacondaDiskGridClass:
+ * @parent_class: The object class structure needs to be the first element in
+ *                the widget class structure in order for the class mechanism
+ *                to work correctly.  This allows a AnacondaDiskGridClass
+ *                pointer to be cast to a #GtkScrolledWindow pointer.
+ * @chosen_changed: Function pointer called when the #AnacondaDiskGrid::chosen-changed
+ *                  signal is emitted.
+ */
+struct _AnacondaDiskGridClass {
+    GtkScrolledWindowClass parent_class;
+
+    void (* chosen_changed)  (AnacondaDiskGrid *grid);
+};
+
+GType         anaconda_disk_grid_get_type (void);
+GtkWidget    *anaconda_disk_grid_new      (void);
+
+GtkListStore *anaconda_disk_grid_new_store(void);
+
+GtkListStore *anaconda_disk_grid_get_model(AnacondaDiskGrid *grid);
+void          anaconda_disk_grid_set_model(AnacondaDiskGrid *grid, GtkListStore *model);
+
+void          anaconda_disk_grid_set_all_chosen(AnacondaDiskGrid *grid, gboolean is_chosen);
+
+G_END_DECLS
+
+#endif
@@ -207,51 +207,26 @@ GtkWidget *anaconda_disk_overview_new() {
     return g_object_new(ANACONDA_TYPE_DISK_OVERVIEW, NULL);
 }
 
+/* Show the icon in kind_icon, which stays in the grid for the life of the
+ * widget.  If the icon cannot be loaded, the old one stays.
+ */
 static void set_icon(AnacondaDiskOverview *widget, const char *icon_name) {
-    GError *err = NULL;
-    GIcon *base_icon, *emblem_icon, *icon;
-    GEmblem *emblem = NULL;
-    gchar *file;
+    gchar *file = NULL;
 
     if (!icon_name)
         return;
 
-    if (widget->priv->kind_icon)
-        gtk_widget_destroy(widget->priv->kind_icon);
-
-    if (widget->priv->chosen) {
-        base_icon = g_icon_new_for_string(icon_name, &err);
-        if (!base_icon) {
-            fprintf(stderr, "could not create icon: %s\n", err->message);
-            g_error_free(err);
-            return;
-        }
+    if (widget->priv->chosen)
+        file = anaconda_widgets_get_pixmap_uri("anaconda-selected-icon.svg");
 
-        file = g_strdup_printf("%s/pixmaps/anaconda-selected-icon.svg", anaconda_get_widgets_datadir());
-        emblem_icon = g_icon_new_for_string(file, &err);
-        g_free(file);
-        if (!emblem_icon) {
-            fprintf(stderr, "could not create emblem: %s\n", err->message);
-            g_error_free(err);
-        }
-        else {
-            emblem = g_emblem_new(emblem_icon);
-        }
+    anaconda_widgets_set_image_icon(GTK_IMAGE(widget->priv->kind_icon), icon_name, file, ICON_SIZE);
+    g_free(file);
+}
 
-        icon = g_emblemed_icon_new(base_icon, emblem);
-        g_object_unref(base_icon);
-    }
-    else {
-        icon = g_icon_new_for_string(icon_name, &err);
-        if (!icon) {
-            fprintf(stderr, "could not create icon: %s\n", err->message);
-            g_error_free(err);
-            return;
-        }
-    }
+static void anaconda_disk_overview_scale_changed(GObject *object, GParamSpec *pspec, gpointer user_data) {
+    AnacondaDiskOverview *widget = ANACONDA_DISK_OVERVIEW(object);
 
-    widget->priv->kind_icon = gtk_image_new_from_gicon(icon, GTK_ICON_SIZE_DIALOG);
-    gtk_image_set_pixel_size(GTK_IMAGE(widget->priv->kind_icon), ICON_SIZE);
+    set_icon(widget, widget->priv->kind ? widget->priv->kind : DEFAULT_KIND);
 }
 
 /* Initialize the widgets in a newly allocated DiskOverview. */
@@ -288,8 +263,12 @@ static void anaconda_disk_overview_init(AnacondaDiskOverview *widget) {
     gtk_label_set_markup(GTK_LABEL(widget->priv->capacity_label), markup);
     g_free(markup);
 
-    /* Create the spoke's icon. */
+    /* Create the spoke's icon, and load it again at the scale of the window
+     * the widget ends up in.
+     */
+    widget->priv->kind_icon = gtk_image_new();
     set_icon(widget, DEFAULT_KIND);
+    g_signal_connect(widget, "notify::scale-factor", G_CALLBACK(anaconda_disk_overview_scale_changed), NULL);
 
     /* Create the description label. */
     widget->priv->description_label = gtk_label_new(NULL);
@@ -345,8 +324,6 @@ gboolean anaconda_disk_overview_clicked(AnacondaDiskOverview *widget, GdkEvent *
 
 static void anaconda_disk_overview_toggle_background(AnacondaDiskOverview *widget) {
     set_icon(widget, widget->priv->kind);
-    gtk_grid_attach(GTK_GRID(widget->priv->grid), widget->priv->kind_icon, 0, 1, 3, 1);
-    gtk_widget_show(widget->priv->kind_icon);
 }
 
 static void anaconda_disk_overview_finalize(AnacondaDiskOverview *widget) {
@@ -408,7 +385,6 @@ static void anaconda_disk_overview_set_property(GObject *object, guint prop_id,
 
             widget->priv->kind = g_strdup(g_value_get_string(value));
             set_icon(widget, widget->priv->kind);
-            gtk_grid_attach(GTK_GRID(widget->priv->grid), widget->priv->kind_icon, 0, 1, 3, 1);
             break;
 
         case PROP_FREE: {
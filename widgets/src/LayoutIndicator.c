@@ -43,6 +43,11 @@
  * indication of currently activated X layout should be shown.
  *
  * An #AnacondaLayoutIndicator is a subclass of a #GtkEventBox.
+ *
+ * The names of all configured layouts are cached when the X configuration
+ * changes, so a change of the active layout is just a lookup. The label and
+ * tooltip are then updated at most once per frame, however many state
+ * changes X reports in the meantime.
  */
 
 enum {
@@ -60,6 +65,13 @@ struct _AnacondaLayoutIndicatorPrivate {
     XklConfigRec *config_rec;
     gulong state_changed_handler_id;
     gulong config_changed_handler_id;
+
+    /* 'layout (variant)' for every configured group */
+    gchar **group_names;
+    guint n_groups;
+
+    /* pending update of the label and tooltip */
+    guint refresh_idle_id;
 };
 
 G_DEFINE_TYPE(AnacondaLayoutIndicator, anaconda_layout_indicator, GTK_TYPE_EVENT_BOX)
@@ -74,9 +86,12 @@ static void anaconda_layout_indicator_clicked(GtkWidget *widget, GdkEvent *event
 static void anaconda_layout_indicator_refresh_ui_elements(AnacondaLayoutIndicator *indicator);
 static void anaconda_layout_indicator_refresh_layout(AnacondaLayoutIndicator *indicator);
 static void anaconda_layout_indicator_refresh_tooltip(AnacondaLayoutIndicator *indicator);
+static void anaconda_layout_indicator_refresh_groups(AnacondaLayoutIndicator *indicator);
+static void anaconda_layout_indicator_set_group(AnacondaLayoutIndicator *indicator, gint group);
+static gboolean anaconda_layout_indicator_refresh_idle(gpointer indicator);
 
 /* helper functions */
-static gchar* get_current_layout(XklEngine *engine, XklConfigRec *conf_rec);
+static gchar* get_layout_name(XklConfigRec *conf_rec, guint group);
 static void x_state_changed(XklEngine *engine, XklEngineStateChange type,
                             gint arg2, gboolean arg3, gpointer indicator);
 static void x_config_changed(XklEngine *engine, gpointer indicator);
@@ -203,7 +218,8 @@ static void anaconda_layout_indicator_init(AnacondaLayoutIndicator *self) {
                                                              g_object_ref(self));
 
     /* init layout attribute with the current layout */
-    self->priv->layout = get_current_layout(klass->engine, self->priv->config_rec);
+    anaconda_layout_indicator_refresh_groups(self);
+    anaconda_layout_indicator_set_group(self, xkl_engine_get_current_state(klass->engine)->group);
 
     /* create layout label and set desired properties */
     self->priv->layout_label = GTK_LABEL(gtk_label_new(NULL));
@@ -241,6 +257,11 @@ static void anaconda_layout_indicator_dispose(GObject *object) {
     g_signal_handler_disconnect(klass->engine, self->priv->state_changed_handler_id);
     g_signal_handler_disconnect(klass->engine, self->priv->config_changed_handler_id);
 
+    if (self->priv->refresh_idle_id) {
+        g_source_remove(self->priv->refresh_idle_id);
+        self->priv->refresh_idle_id = 0;
+    }
+
     /* unref all objects we reference (may be called multiple times) */
     if (self->priv->layout_label) {
         gtk_widget_destroy(GTK_WIDGET(self->priv->layout_label));
@@ -258,6 +279,11 @@ static void anaconda_layout_indicator_dispose(GObject *object) {
         g_free(self->priv->layout);
         self->priv->layout = NULL;
     }
+    if (self->priv->group_names) {
+        g_strfreev(self->priv->group_names);
+        self->priv->group_names = NULL;
+        self->priv->n_groups = 0;
+    }
 }
 
 static void anaconda_layout_indicator_realize(GtkWidget *widget, gpointer data) {
@@ -324,18 +350,66 @@ static void anaconda_layout_indicator_refresh_ui_elements(AnacondaLayoutIndicato
 static void anaconda_layout_indicator_refresh_layout(AnacondaLayoutIndicator *self) {
     AnacondaLayoutIndicatorClass *klass = ANACONDA_LAYOUT_INDICATOR_GET_CLASS(self);
 
+    anaconda_layout_indicator_set_group(self, xkl_engine_get_current_state(klass->engine)->group);
+}
+
+/* Rebuild the cached layout names from the current configuration. */
+static void anaconda_layout_indicator_refresh_groups(AnacondaLayoutIndicator *self) {
+    guint i;
+
+    g_strfreev(self->priv->group_names);
+
+    self->priv->n_groups = self->priv->config_rec->layouts ?
+        g_strv_length(self->priv->config_rec->layouts) : 0;
+    self->priv->group_names = g_new0(gchar *, self->priv->n_groups + 1);
+    for (i = 0; i < self->priv->n_groups; i++)
+        self->priv->group_names[i] = get_layout_name(self->priv->config_rec, i);
+}
+
+/*
+ * Make group the current layout. The label and tooltip are only updated once
+ * the main loop gets around to redrawing, so a burst of changes costs a
+ * single update.
+ */
+static void anaconda_layout_indicator_set_group(AnacondaLayoutIndicator *self, gint group) {
+    const gchar *name;
+
+    if (self->priv->n_groups == 0)
+        name = DEFAULT_LAYOUT;
+    /* BUG?: if the last layout in the list is activated and removed,
+             group may be equal to n_groups
+    */
+    else if (group < 0 || (guint) group >= self->priv->n_groups)
+        name = self->priv->group_names[self->priv->n_groups - 1];
+    else
+        name = self->priv->group_names[group];
+
+    if (!g_strcmp0(name, self->priv->layout))
+        return;
+
     g_free(self->priv->layout);
-    self->priv->layout = get_current_layout(klass->engine, self->priv->config_rec);
+    self->priv->layout = g_strdup(name);
+
+    /* the label does not exist yet while the widget is being initialized */
+    if (self->priv->layout_label && !self->priv->refresh_idle_id)
+        self->priv->refresh_idle_id = g_idle_add_full(GDK_PRIORITY_REDRAW,
+                                                      anaconda_layout_indicator_refresh_idle,
+                                                      self, NULL);
+}
 
+static gboolean anaconda_layout_indicator_refresh_idle(gpointer data) {
+    AnacondaLayoutIndicator *self = ANACONDA_LAYOUT_INDICATOR(data);
+
+    self->priv->refresh_idle_id = 0;
     anaconda_layout_indicator_refresh_ui_elements(self);
+
+    return FALSE;
 }
 
 static void anaconda_layout_indicator_refresh_tooltip(AnacondaLayoutIndicator *self) {
-    AnacondaLayoutIndicatorClass *klass = ANACONDA_LAYOUT_INDICATOR_GET_CLASS(self);
-    guint n_groups = xkl_engine_get_num_groups(klass->engine);
     gchar *tooltip;
 
-    if (n_groups > 1)
+    if (self->priv->n_groups > 1)
         tooltip = g_strdup_printf(MULTIPLE_LAYOUTS_TIP, self->priv->layout);
     else
         tooltip = g_strdup_printf(SINGLE_LAYOUT_TIP, self->priv->layout);
@@ -345,34 +419,18 @@ static void anaconda_layout_indicator_refresh_tooltip(AnacondaLayoutIndicator *s
 }
 
 /**
- * get_current_layout:
+ * get_layout_name:
  *
- * Returns: newly allocated string with the currently activated layout as
+ * Returns: newly allocated string with the layout of the given group as
  *          'layout (variant)'
  */
-static gchar* get_current_layout(XklEngine *engine, XklConfigRec *conf_rec) {
-    /* engine has to be listening with XKLL_TRACK_KEYBOARD_STATE mask */
-    gchar *layout = NULL;
+static gchar* get_layout_name(XklConfigRec *conf_rec, guint group) {
+    gchar *layout = conf_rec->layouts[group];
     gchar *variant = NULL;
-    gint32 cur_group;
 
-    /* returns statically allocated buffer, shouldn't be freed */
-    XklState *state = xkl_engine_get_current_state(engine);
-    cur_group = state->group;
-
-    guint n_groups = xkl_engine_get_num_groups(engine);
-
-    /* BUG?: if the last layout in the list is activated and removed,
-             state->group may be equal to n_groups that would result in
-             layout being NULL
-    */
-    if (cur_group >= n_groups)
-        cur_group = n_groups - 1;
-
-    layout = conf_rec->layouts[cur_group];
-
-    /* variant defined for the current layout */
-    variant = conf_rec->variants[cur_group];
+    /* variant defined for the layout, variants may be shorter than layouts */
+    if (conf_rec->variants && group < g_strv_length(conf_rec->variants))
+        variant = conf_rec->variants[group];
 
     /* variant may be NULL or "" if not defined */
     if (variant && g_strcmp0("", variant))
@@ -395,7 +453,12 @@ static void x_state_changed(XklEngine *engine, XklEngineStateChange type,
     g_return_if_fail(data);
     AnacondaLayoutIndicator *indicator = ANACONDA_LAYOUT_INDICATOR(data);
 
-    anaconda_layout_indicator_refresh_layout(indicator);
+    /* indicator (Caps Lock and friends) changes do not affect the layout */
+    if (type != GROUP_CHANGED)
+        return;
+
+    /* for GROUP_CHANGED arg2 is the new group */
+    anaconda_layout_indicator_set_group(indicator, arg2);
 }
 
 static void x_config_changed(XklEngine *engine, gpointer data) {
@@ -405,7 +468,12 @@ static void x_config_changed(XklEngine *engine, gpointer data) {
 
     /* load current configuration from the X server */
     xkl_config_rec_get_from_server(indicator->priv->config_rec, klass->engine);
+    anaconda_layout_indicator_refresh_groups(indicator);
 
+    /* the name of the current group may be different even if the group is not,
+       and the tooltip depends on the number of groups */
+    g_free(indicator->priv->layout);
+    indicator->priv->layout = NULL;
     anaconda_layout_indicator_refresh_layout(indicator);
 }
 
@@ -49,6 +49,17 @@
  * surface using the parent's Gdk window as the source pattern, apply a 50%
  * translucent fill to the surface, and then use this surface as the
  * background for the lightbox's Gdk window.
+ *
+ * Creating that surface is expensive on remote displays, so the shade surface
+ * is parked on the parent window when a lightbox is destroyed and picked up
+ * again by the next lightbox with the same parent, and the shade is only
+ * repainted when the parent actually changes size. Bursts of configure events
+ * are coalesced into one repaint per frame.
+ *
+ * Once the lightbox is mapped it covers the parent, and without compositing a
+ * copy of the parent's window would include the shade itself. So the parent
+ * is only copied while the lightbox is unmapped, and a repaint after a resize
+ * dims that undimmed copy again.
  */
 
 #include <cairo.h>
@@ -58,22 +69,46 @@
 
 #include "intl.h"
 
+/* Key for the spare shade surface parked on the parent window */
+#define LIGHTBOX_SHADE_KEY "anaconda-lightbox-shade"
+
 enum {
     PROP_PARENT_WINDOW = 1
 };
 
+/*
+ * A dimmed snapshot of the parent window and the size it was created at, and
+ * the undimmed snapshot it was made from
+ */
+typedef struct {
+    cairo_surface_t *surface;
+    gint             width;
+    gint             height;
+
+    cairo_surface_t *snapshot;
+    gint             snapshot_width;
+    gint             snapshot_height;
+} AnacondaLightboxShade;
+
 struct _AnacondaLightboxPrivate {
     GtkWindow *transient_parent;
     gboolean   parent_configure_event_handler_set;
     guint      parent_configure_event_handler;
 
     gboolean   composited;
+
+    /* Background for the non-compositing case */
+    AnacondaLightboxShade *shade;
+    guint                  shade_idle_source;
 };
 
 static void anaconda_lightbox_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec);
 static void anaconda_lightbox_set_parent_window(GObject *gobject, GParamSpec *psec, gpointer user_data);
 
 static gboolean anaconda_lb_parent_configure_event(GtkWidget *parent, GdkEvent *event, gpointer lightbox);
+static void anaconda_lb_update_shade(AnacondaLightbox *lightbox);
+static void anaconda_lb_shade_free(AnacondaLightboxShade *shade);
+static gboolean anaconda_lb_update_shade_idle(gpointer lightbox);
 static void anaconda_lb_cleanup(GtkWidget *widget, gpointer user_data);
 
 G_DEFINE_TYPE(AnacondaLightbox, anaconda_lightbox, GTK_TYPE_WINDOW)
@@ -174,6 +209,7 @@ static gboolean anaconda_lb_parent_configure_event(
         )
 {
     /* Always return FALSE to continue processing for this signal. */
+    AnacondaLightboxPrivate *priv;
     GdkWindow *g_lightbox_window;
     gint x, y, width, height;
 
@@ -209,9 +245,150 @@ static gboolean anaconda_lb_parent_configure_event(
                 );
     }
 
+    /*
+     * Only a size change invalidates the shade. Wait until the next frame to
+     * repaint it so that a drag-resize does not snapshot the parent on every
+     * intermediate configure event.
+     */
+    priv = ANACONDA_LIGHTBOX(lightbox)->priv;
+    if (!priv->composited && (NULL != priv->shade) && (0 == priv->shade_idle_source) &&
+            ((event->configure.width != priv->shade->width) ||
+             (event->configure.height != priv->shade->height)))
+    {
+        priv->shade_idle_source = g_idle_add_full(GDK_PRIORITY_REDRAW,
+                anaconda_lb_update_shade_idle, g_object_ref(lightbox), g_object_unref);
+    }
+
+    return FALSE;
+}
+
+static gboolean anaconda_lb_update_shade_idle(gpointer lightbox)
+{
+    ANACONDA_LIGHTBOX(lightbox)->priv->shade_idle_source = 0;
+    anaconda_lb_update_shade(ANACONDA_LIGHTBOX(lightbox));
+
     return FALSE;
 }
 
+static void anaconda_lb_shade_free(AnacondaLightboxShade *shade)
+{
+    cairo_surface_destroy(shade->snapshot);
+    cairo_surface_destroy(shade->surface);
+    g_slice_free(AnacondaLightboxShade, shade);
+}
+
+/*
+ * Paint a dimmed copy of the parent window and install it as the lightbox
+ * background. The shade surface is reused whenever its size still matches
+ * the parent; a spare one left behind by an earlier lightbox is adopted if
+ * this lightbox does not have one yet. The parent is only copied again while
+ * the lightbox does not cover it.
+ */
+static void anaconda_lb_update_shade(AnacondaLightbox *lightbox)
+{
+    AnacondaLightboxPrivate *priv = lightbox->priv;
+
+    GdkWindow *g_lightbox_window;
+    GdkWindow *g_parent_window;
+    cairo_pattern_t *pattern;
+    cairo_t *cr;
+    gint width, height;
+
+    if (NULL == priv->transient_parent)
+    {
+        return;
+    }
+
+    g_lightbox_window = gtk_widget_get_window(GTK_WIDGET(lightbox));
+    g_parent_window = gtk_widget_get_window(GTK_WIDGET(priv->transient_parent));
+    if ((NULL == g_lightbox_window) || (NULL == g_parent_window))
+    {
+        return;
+    }
+
+    width = gdk_window_get_width(g_parent_window);
+    height = gdk_window_get_height(g_parent_window);
+
+    if (NULL == priv->shade)
+    {
+        priv->shade = g_object_steal_data(G_OBJECT(priv->transient_parent), LIGHTBOX_SHADE_KEY);
+    }
+
+    if (NULL == priv->shade)
+    {
+        priv->shade = g_slice_new0(AnacondaLightboxShade);
+    }
+
+    /*
+     * Copy the parent while nothing covers it. Once the lightbox is mapped,
+     * keep the copy from before; the parts of the parent that a resize
+     * uncovered are left black.
+     */
+    if (!gtk_widget_get_mapped(GTK_WIDGET(lightbox)) || (NULL == priv->shade->snapshot))
+    {
+        if ((NULL != priv->shade->snapshot) &&
+                ((width != priv->shade->snapshot_width) || (height != priv->shade->snapshot_height)))
+        {
+            cairo_surface_destroy(priv->shade->snapshot);
+            priv->shade->snapshot = NULL;
+        }
+
+        if (NULL == priv->shade->snapshot)
+        {
+            priv->shade->snapshot = gdk_window_create_similar_surface(g_lightbox_window,
+                    CAIRO_CONTENT_COLOR, width, height);
+            priv->shade->snapshot_width = width;
+            priv->shade->snapshot_height = height;
+        }
+
+        cr = cairo_create(priv->shade->snapshot);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        gdk_cairo_set_source_window(cr, g_parent_window, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    }
+
+    /* Create a new surface that supports alpha content if the size changed */
+    if ((NULL != priv->shade->surface) && ((width != priv->shade->width) || (height != priv->shade->height)))
+    {
+        cairo_surface_destroy(priv->shade->surface);
+        priv->shade->surface = NULL;
+    }
+
+    if (NULL == priv->shade->surface)
+    {
+        priv->shade->surface = gdk_window_create_similar_surface(g_lightbox_window,
+                CAIRO_CONTENT_COLOR_ALPHA, width, height);
+        priv->shade->width = width;
+        priv->shade->height = height;
+    }
+
+    cr = cairo_create(priv->shade->surface);
+
+    /*
+     * Paint the copy of the parent at half strength over opaque black. This
+     * gives the same result as painting the parent and then a 50% black shade
+     * on top, but the dimming happens as part of the copy instead of as a
+     * second blend over the whole surface.
+     */
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    cairo_paint(cr);
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_set_source_surface(cr, priv->shade->snapshot, 0, 0);
+    cairo_paint_with_alpha(cr, 0.5);
+
+    cairo_destroy(cr);
+
+    /* Use the surface we painted as the window background */
+    pattern = cairo_pattern_create_for_surface(priv->shade->surface);
+    gdk_window_set_background_pattern(g_lightbox_window, pattern);
+    cairo_pattern_destroy(pattern);
+
+    gdk_window_invalidate_rect(g_lightbox_window, NULL, FALSE);
+}
+
 
 /*
  * Draw the window background. Uses the gobject notify handler signature
@@ -225,11 +402,7 @@ static void anaconda_lightbox_set_parent_window(
 {
     AnacondaLightbox *lightbox;
 
-    GdkWindow *g_lightbox_window;
     GdkWindow *g_parent_window;
-    cairo_surface_t *surface;
-    cairo_pattern_t *pattern;
-    cairo_t *cr;
 
     if (!ANACONDA_IS_LIGHTBOX(gobject))
     {
@@ -285,29 +458,8 @@ static void anaconda_lightbox_set_parent_window(
             {
                 gtk_widget_realize(GTK_WIDGET(lightbox));
             }
-            g_lightbox_window = gtk_widget_get_window(GTK_WIDGET(lightbox));
-
-            /* Create a new surface that supports alpha content */
-            surface = gdk_window_create_similar_surface(g_lightbox_window,
-                    CAIRO_CONTENT_COLOR_ALPHA,
-                    gdk_window_get_width(g_parent_window),
-                    gdk_window_get_height(g_parent_window));
-            cr = cairo_create(surface);
-
-            /* Use the parent window as a pattern and paint it on the surface */
-            gdk_cairo_set_source_window(cr, g_parent_window, 0, 0);
-            cairo_paint(cr);
 
-            /* Paint a black, 50% transparent shade */
-            cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.5);
-            cairo_paint(cr);
-
-            cairo_destroy(cr);
-
-            /* Use the surface we painted as the window background */
-            pattern = cairo_pattern_create_for_surface(surface);
-            gdk_window_set_background_pattern(g_lightbox_window, pattern);
-            cairo_pattern_destroy(pattern);
+            anaconda_lb_update_shade(lightbox);
         }
     }
 
@@ -332,6 +484,32 @@ static void anaconda_lb_cleanup(GtkWidget *widget, gpointer user_data)
             g_object_unref(lightbox);
         }
 
+        if (lightbox->priv->shade_idle_source != 0)
+        {
+            g_source_remove(lightbox->priv->shade_idle_source);
+            lightbox->priv->shade_idle_source = 0;
+        }
+
+        /*
+         * Park the shade surface on the parent for the next lightbox, unless
+         * another lightbox already left one there.
+         */
+        if (NULL != lightbox->priv->shade)
+        {
+            if ((NULL != lightbox->priv->transient_parent) &&
+                    (NULL == g_object_get_data(G_OBJECT(lightbox->priv->transient_parent), LIGHTBOX_SHADE_KEY)))
+            {
+                g_object_set_data_full(G_OBJECT(lightbox->priv->transient_parent),
+                        LIGHTBOX_SHADE_KEY, lightbox->priv->shade,
+                        (GDestroyNotify) anaconda_lb_shade_free);
+            }
+            else
+            {
+                anaconda_lb_shade_free(lightbox->priv->shade);
+            }
+            lightbox->priv->shade = NULL;
+        }
+
         /* Drop the reference for the parent window */
         g_object_unref(lightbox->priv->transient_parent);
         lightbox->priv->transient_parent = NULL;
@@ -169,7 +169,7 @@ static void format_name_label(AnacondaMountpointSelector *widget, const char *va
 }
 
 static void anaconda_mountpoint_selector_init(AnacondaMountpointSelector *mountpoint) {
-    gchar *file;
+    GdkPixbuf *pixbuf;
 
     mountpoint->priv = G_TYPE_INSTANCE_GET_PRIVATE(mountpoint,
                                                    ANACONDA_TYPE_MOUNTPOINT_SELECTOR,
@@ -190,16 +190,20 @@ static void anaconda_mountpoint_selector_init(AnacondaMountpointSelector *mountp
     gtk_grid_set_column_spacing(GTK_GRID(mountpoint->priv->grid), 12);
     gtk_widget_set_margin_start(GTK_WIDGET(mountpoint->priv->grid), 30);
 
-    /* Create the icon.  We don't need to check if it returned NULL since
-     * gtk_image_new_from_file will just display a broken image icon in that
-     * case.  That's good enough error notification.
+    /* Create the icon.  If the pixmap can't be loaded, display a broken
+     * image icon instead.  That's good enough error notification.
      */
     if (gtk_get_locale_direction() == GTK_TEXT_DIR_LTR)
-        file = g_strdup_printf("%s/pixmaps/right-arrow-icon.png", anaconda_get_widgets_datadir());
+        pixbuf = anaconda_widgets_load_pixmap("right-arrow-icon.png", -1, NULL);
     else
-        file = g_strdup_printf("%s/pixmaps/left-arrow-icon.png", anaconda_get_widgets_datadir());
-    mountpoint->priv->arrow = gtk_image_new_from_file(file);
-    g_free(file);
+        pixbuf = anaconda_widgets_load_pixmap("left-arrow-icon.png", -1, NULL);
+
+    if (pixbuf) {
+        mountpoint->priv->arrow = gtk_image_new_from_pixbuf(pixbuf);
+        g_object_unref(pixbuf);
+    } else {
+        mountpoint->priv->arrow = gtk_image_new_from_icon_name("image-missing", GTK_ICON_SIZE_BUTTON);
+    }
     gtk_widget_set_no_show_all(GTK_WIDGET(mountpoint->priv->arrow), TRUE);
 
     /* Set some properties. */
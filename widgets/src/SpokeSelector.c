@@ -186,65 +186,29 @@ static void format_title_label(AnacondaSpokeSelector *widget, const char *label)
     g_free(markup);
 }
 
+/* Show the icon in the selector's image, which stays in the grid for the
+ * life of the widget.  If the icon cannot be loaded, the old one stays.
+ */
 static void set_icon(AnacondaSpokeSelector *widget, const char *icon_name) {
-    GError *err = NULL;
-    GIcon *base_icon, *emblem_icon, *icon;
-    GEmblem *emblem = NULL;
-
-    GtkIconTheme *icon_theme;
-    GtkIconInfo *icon_info;
-    GdkPixbuf *pixbuf;
-    gchar *file;
+    gchar *file = NULL;
 
     if (!icon_name)
         return;
 
-    if (widget->priv->icon)
-        gtk_widget_destroy(widget->priv->icon);
-
-    if (widget->priv->is_incomplete) {
-        base_icon = g_icon_new_for_string(icon_name, &err);
-        if (!base_icon) {
-            fprintf(stderr, "could not create icon: %s\n", err->message);
-            g_error_free(err);
-            return;
-        }
+    /* GTK doesn't want to emblem a symbolic icon, so for now here's a
+     * workaround: the cache loads the emblemed icon into a pixbuf.
+     */
+    if (widget->priv->is_incomplete)
+        file = anaconda_widgets_get_pixmap_uri("dialog-warning-symbolic.svg");
 
-        file = g_strdup_printf("%s/pixmaps/dialog-warning-symbolic.svg", anaconda_get_widgets_datadir());
-        emblem_icon = g_icon_new_for_string(file, &err);
-        g_free(file);
-        if (!emblem_icon) {
-            fprintf(stderr, "could not create emblem: %s\n", err->message);
-            g_error_free(err);
-        } else {
-            emblem = g_emblem_new(emblem_icon);
-        }
+    anaconda_widgets_set_image_icon(GTK_IMAGE(widget->priv->icon), icon_name, file, 64);
+    g_free(file);
+}
 
-        icon = g_emblemed_icon_new(base_icon, emblem);
-    }
-    else {
-        icon = g_icon_new_for_string(icon_name, &err);
-        if (!icon) {
-            fprintf(stderr, "could not create icon: %s\n", err->message);
-            g_error_free(err);
-            return;
-        }
-    }
+static void anaconda_spoke_selector_scale_changed(GObject *object, GParamSpec *pspec, gpointer user_data) {
+    AnacondaSpokeSelector *widget = ANACONDA_SPOKE_SELECTOR(object);
 
-    /* GTK doesn't want to emblem a symbolic icon, so for now here's a
-     * workaround.
-     */
-    icon_theme = gtk_icon_theme_get_default();
-    icon_info = gtk_icon_theme_lookup_by_gicon(icon_theme,
-                                               icon,
-                                               64, 0);
-    pixbuf = gtk_icon_info_load_icon(icon_info, NULL);
-
-    widget->priv->icon = gtk_image_new_from_pixbuf(pixbuf);
-    gtk_image_set_pixel_size(GTK_IMAGE(widget->priv->icon), 64);
-    gtk_widget_set_valign(widget->priv->icon, GTK_ALIGN_START);
-    gtk_misc_set_padding(GTK_MISC(widget->priv->icon), 12, 0);
-    gtk_grid_attach(GTK_GRID(widget->priv->grid), widget->priv->icon, 0, 0, 1, 2);
+    set_icon(widget, widget->priv->icon_name);
 }
 
 static void anaconda_spoke_selector_init(AnacondaSpokeSelector *spoke) {
@@ -271,9 +235,15 @@ static void anaconda_spoke_selector_init(AnacondaSpokeSelector *spoke) {
     spoke->priv->grid = gtk_grid_new();
     gtk_grid_set_column_spacing(GTK_GRID(spoke->priv->grid), 6);
 
-    /* Create the icon. */
+    /* Create the icon, and load it again at the scale of the window the
+     * widget ends up in.
+     */
+    spoke->priv->icon = gtk_image_new();
+    gtk_widget_set_valign(spoke->priv->icon, GTK_ALIGN_START);
+    gtk_misc_set_padding(GTK_MISC(spoke->priv->icon), 12, 0);
     spoke->priv->icon_name = g_strdup(DEFAULT_ICON);
     set_icon(spoke, spoke->priv->icon_name);
+    g_signal_connect(spoke, "notify::scale-factor", G_CALLBACK(anaconda_spoke_selector_scale_changed), NULL);
 
     /* Create the title label. */
     spoke->priv->title_label = gtk_label_new(NULL);
@@ -292,9 +262,8 @@ static void anaconda_spoke_selector_init(AnacondaSpokeSelector *spoke) {
     gtk_label_set_max_width_chars(GTK_LABEL(spoke->priv->status_label), 45);
     gtk_widget_set_hexpand(GTK_WIDGET(spoke->priv->status_label), FALSE);
 
-    /* Add everything to the grid, add the grid to the widget.  The icon is attached by
-     * the call to set_icon earlier.
-     */
+    /* Add everything to the grid, add the grid to the widget. */
+    gtk_grid_attach(GTK_GRID(spoke->priv->grid), spoke->priv->icon, 0, 0, 1, 2);
     gtk_grid_attach(GTK_GRID(spoke->priv->grid), spoke->priv->title_label, 1, 0, 1, 1);
     gtk_grid_attach(GTK_GRID(spoke->priv->grid), spoke->priv->status_label, 1, 1, 2, 1);
 
@@ -334,7 +303,6 @@ static void anaconda_spoke_selector_set_property(GObject *object, guint prop_id,
 
             widget->priv->icon_name = g_strdup(g_value_get_string(value));
             set_icon(widget, widget->priv->icon_name);
-            gtk_widget_show_all(widget->priv->icon);
             break;
 
         case PROP_STATUS: {
@@ -380,7 +348,6 @@ void anaconda_spoke_selector_set_incomplete(AnacondaSpokeSelector *spoke, gboole
 
     /* Update the icon we are displaying, complete with any warning emblem. */
     set_icon(spoke, spoke->priv->icon_name);
-    gtk_widget_show_all(spoke->priv->icon);
 
     /* We need to update the status label's color, in case this spoke was
      * previously incomplete but now is not (or the other way around).
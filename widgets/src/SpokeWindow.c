@@ -216,7 +216,6 @@ static void anaconda_spoke_window_realize(GtkWidget *widget, gpointer user_data)
     cairo_pattern_t *pattern;
     cairo_surface_t *surface;
     cairo_t *cr;
-    gchar *file;
 
     AnacondaSpokeWindow *window = ANACONDA_SPOKE_WINDOW(widget);
 
@@ -225,12 +224,11 @@ static void anaconda_spoke_window_realize(GtkWidget *widget, gpointer user_data)
      * header without an image.
      */
     error = NULL;
-    file = g_strdup_printf("%s/pixmaps/anaconda_spoke_header.png", anaconda_get_widgets_datadir());
 
     nav_box = anaconda_base_window_get_nav_area_background_window(ANACONDA_BASE_WINDOW(window));
-    pixbuf = gdk_pixbuf_new_from_file_at_scale(file, -1, gdk_window_get_height(gtk_widget_get_window(nav_box)), FALSE, &error);
+    pixbuf = anaconda_widgets_load_pixmap("anaconda_spoke_header.png",
+                                          gdk_window_get_height(gtk_widget_get_window(nav_box)), &error);
 
-    g_free(file);
     if (!pixbuf) {
         fprintf(stderr, "could not load header background: %s\n", error->message);
         g_error_free(error);
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2014  Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A small benchmark for libAnacondaWidgets.  For each widget and instance
+ * count, it creates that many instances and reports how long it took to
+ * create, realize, size-allocate and draw them, along with the resident
+ * memory each instance added.
+ *
+ * This needs a display, but not a visible one.  "make run-benchmark" in the
+ * widgets directory runs it under xvfb-run.  GDK_BACKEND=broadway works too,
+ * except for AnacondaLayoutIndicator, which needs X for libxklavier.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gtk/gtk.h>
+
+#include "BaseWindow.h"
+#include "DiskOverview.h"
+#include "HubWindow.h"
+#include "LayoutIndicator.h"
+#include "Lightbox.h"
+#include "MountpointSelector.h"
+#include "SpokeSelector.h"
+
+#define DEFAULT_COUNTS "1,100,1000"
+
+typedef GtkWidget *(*BenchmarkNewFunc) (GtkWindow *parent);
+
+typedef struct {
+    const gchar      *name;
+    BenchmarkNewFunc  new_func;
+    /* Whether the widget is a window of its own, as opposed to something
+     * that has to be packed into one.
+     */
+    gboolean          toplevel;
+} BenchmarkWidget;
+
+typedef struct {
+    gint64 create, realize, allocate, draw;
+    glong  rss;
+} BenchmarkResult;
+
+static GtkWidget *new_base_window(GtkWindow *parent) {
+    return anaconda_base_window_new();
+}
+
+static GtkWidget *new_hub_window(GtkWindow *parent) {
+    return anaconda_hub_window_new();
+}
+
+static GtkWidget *new_spoke_selector(GtkWindow *parent) {
+    return anaconda_spoke_selector_new();
+}
+
+static GtkWidget *new_disk_overview(GtkWindow *parent) {
+    return anaconda_disk_overview_new();
+}
+
+static GtkWidget *new_mountpoint_selector(GtkWindow *parent) {
+    return anaconda_mountpoint_selector_new();
+}
+
+static GtkWidget *new_lightbox(GtkWindow *parent) {
+    return anaconda_lightbox_new(parent);
+}
+
+static GtkWidget *new_layout_indicator(GtkWindow *parent) {
+    return anaconda_layout_indicator_new();
+}
+
+static const BenchmarkWidget widgets[] = {
+    { "BaseWindow",         new_base_window,         TRUE },
+    { "HubWindow",          new_hub_window,          TRUE },
+    { "SpokeSelector",      new_spoke_selector,      FALSE },
+    { "DiskOverview",       new_disk_overview,       FALSE },
+    { "MountpointSelector", new_mountpoint_selector, FALSE },
+    { "Lightbox",           new_lightbox,            TRUE },
+    { "LayoutIndicator",    new_layout_indicator,    FALSE },
+};
+
+static gchar *counts_arg = NULL;
+
+static GOptionEntry entries[] = {
+    { "counts", 'c', 0, G_OPTION_ARG_STRING, &counts_arg,
+      "Comma separated list of instance counts (default: " DEFAULT_COUNTS ")", "N,..." },
+    { NULL }
+};
+
+/* Resident set size of this process in bytes, or 0 if it cannot be read. */
+static glong get_rss(void) {
+    gchar *contents = NULL;
+    glong size, resident = 0;
+
+    if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+        return 0;
+
+    if (sscanf(contents, "%ld %ld", &size, &resident) != 2)
+        resident = 0;
+
+    g_free(contents);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/* Let the widgets finish whatever they deferred to the main loop. */
+static void flush_events(void) {
+    while (gtk_events_pending())
+        gtk_main_iteration();
+}
+
+static void run_benchmark(const BenchmarkWidget *widget, gint count, GtkWindow *parent, BenchmarkResult *result) {
+    GtkWidget **instances = g_new0(GtkWidget *, count);
+    GtkWidget *container = NULL, *box = NULL;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    glong rss_before;
+    gint64 start;
+    gint i;
+
+    flush_events();
+    rss_before = get_rss();
+
+    /* create */
+    start = g_get_monotonic_time();
+
+    if (!widget->toplevel) {
+        container = gtk_offscreen_window_new();
+        box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+        gtk_container_add(GTK_CONTAINER(container), box);
+    }
+
+    for (i = 0; i < count; i++) {
+        instances[i] = widget->new_func(parent);
+
+        if (box)
+            gtk_box_pack_start(GTK_BOX(box), instances[i], FALSE, FALSE, 0);
+    }
+
+    result->create = g_get_monotonic_time() - start;
+
+    /* realize */
+    start = g_get_monotonic_time();
+
+    if (container) {
+        gtk_widget_show_all(container);
+    } else {
+        for (i = 0; i < count; i++)
+            gtk_widget_realize(instances[i]);
+    }
+
+    flush_events();
+    result->realize = g_get_monotonic_time() - start;
+
+    /* size-allocate: measure and lay out every instance at its natural size */
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < count; i++) {
+        GtkRequisition natural;
+        GtkAllocation allocation = { 0, 0, 0, 0 };
+
+        gtk_widget_get_preferred_size(instances[i], NULL, &natural);
+        allocation.width = MAX(natural.width, 1);
+        allocation.height = MAX(natural.height, 1);
+        gtk_widget_size_allocate(instances[i], &allocation);
+    }
+
+    result->allocate = g_get_monotonic_time() - start;
+
+    /* draw everything onto one image, the way a frame would be painted */
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1024, 768);
+    cr = cairo_create(surface);
+
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < count; i++) {
+        cairo_save(cr);
+        gtk_widget_draw(instances[i], cr);
+        cairo_restore(cr);
+    }
+
+    cairo_surface_flush(surface);
+    result->draw = g_get_monotonic_time() - start;
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    result->rss = get_rss() - rss_before;
+
+    if (container) {
+        gtk_widget_destroy(container);
+    } else {
+        for (i = 0; i < count; i++)
+            gtk_widget_destroy(instances[i]);
+    }
+
+    g_free(instances);
+    flush_events();
+}
+
+int main(int argc, char *argv[]) {
+    GError *error = NULL;
+    GtkWidget *parent;
+    gchar **counts;
+    guint i, j;
+
+    if (!gtk_init_with_args(&argc, &argv, "[WIDGET...]", entries, NULL, &error)) {
+        fprintf(stderr, "%s\n", error ? error->message : "Unable to open a display");
+        return 1;
+    }
+
+    counts = g_strsplit(counts_arg ? counts_arg : DEFAULT_COUNTS, ",", -1);
+
+    /* The lightbox shades its parent, so give it something to shade. */
+    parent = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_default_size(GTK_WINDOW(parent), 1024, 768);
+    gtk_widget_show(parent);
+    flush_events();
+
+    printf("%-20s %6s %11s %11s %11s %11s %12s\n", "widget", "count",
+           "create ms", "realize ms", "alloc ms", "draw ms", "KiB/inst");
+
+    for (i = 0; i < G_N_ELEMENTS(widgets); i++) {
+        /* Any remaining arguments restrict which widgets are run. */
+        if (argc > 1) {
+            gboolean wanted = FALSE;
+            gint k;
+
+            for (k = 1; k < argc; k++) {
+                if (strcmp(argv[k], widgets[i].name) == 0)
+                    wanted = TRUE;
+            }
+
+            if (!wanted)
+                continue;
+        }
+
+        for (j = 0; counts[j]; j++) {
+            BenchmarkResult result;
+            gint count = atoi(counts[j]);
+
+            if (count <= 0)
+                continue;
+
+            run_benchmark(&widgets[i], count, GTK_WINDOW(parent), &result);
+
+            printf("%-20s %6d %11.3f %11.3f %11.3f %11.3f %12.1f\n",
+                   widgets[i].name, count,
+                   result.create / 1000.0, result.realize / 1000.0,
+                   result.allocate / 1000.0, result.draw / 1000.0,
+                   result.rss / 1024.0 / count);
+            fflush(stdout);
+        }
+    }
+
+    g_strfreev(counts);
+    gtk_widget_destroy(parent);
+    return 0;
+}
@@ -21,8 +21,18 @@
  */
 
 #include <glib.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+#include "widgets-common.h"
+
+/* Where the pixmaps compiled into the library live, see anaconda-widgets.gresource.xml */
+#define PIXMAPS_RESOURCE_PATH "/org/fedoraproject/anaconda/widgets/pixmaps"
+
+/* Icons already loaded, keyed by name, emblem, size and scale */
+static GHashTable *icon_cache = NULL;
+
 /**
  * anaconda_get_widgets_datadir:
  *
@@ -44,3 +54,214 @@ const gchar *anaconda_get_widgets_datadir(void) {
     else
         return env_value;
 }
+
+/*
+ * Return the resource path of the pixmap called name, or NULL if the pixmap
+ * should be loaded from the widgets data directory instead.  Setting
+ * ANACONDA_WIDGETS_DATA means the files there are wanted, e.g. because they
+ * are being worked on or come from an updates image.
+ */
+static gchar *anaconda_widgets_get_pixmap_resource(const gchar *name) {
+    gchar *path;
+
+    if (getenv("ANACONDA_WIDGETS_DATA") != NULL)
+        return NULL;
+
+    path = g_strdup_printf("%s/%s", PIXMAPS_RESOURCE_PATH, name);
+    if (!g_resources_get_info(path, G_RESOURCE_LOOKUP_FLAGS_NONE, NULL, NULL, NULL)) {
+        g_free(path);
+        return NULL;
+    }
+
+    return path;
+}
+
+/**
+ * anaconda_widgets_get_pixmap_uri:
+ * @name: The file name of the pixmap, e.g. "left-arrow-icon.png".
+ *
+ * Return a URI for one of the pixmaps used by the anaconda widgets.  This
+ * points into the resources compiled into the library unless the
+ * ANACONDA_WIDGETS_DATA environment variable is set, in which case it points
+ * to the file in the widgets data directory.  The URI can be passed to
+ * g_icon_new_for_string() or g_file_new_for_uri().
+ *
+ * Returns: the URI of the pixmap.  Free with g_free().
+ */
+gchar *anaconda_widgets_get_pixmap_uri(const gchar *name) {
+    gchar *resource, *file, *uri;
+
+    resource = anaconda_widgets_get_pixmap_resource(name);
+    if (resource) {
+        uri = g_strconcat("resource://", resource, NULL);
+        g_free(resource);
+        return uri;
+    }
+
+    file = g_strdup_printf("%s/pixmaps/%s", anaconda_get_widgets_datadir(), name);
+    uri = g_filename_to_uri(file, NULL, NULL);
+    g_free(file);
+    return uri;
+}
+
+/**
+ * anaconda_widgets_load_pixmap:
+ * @name: The file name of the pixmap, e.g. "left-arrow-icon.png".
+ * @height: The height to scale the pixmap to, or -1 to keep its own height.
+ * @error: (allow-none): Return location for an error, or %NULL.
+ *
+ * Load one of the pixmaps used by the anaconda widgets, from the resources
+ * compiled into the library or from the widgets data directory as described
+ * for anaconda_widgets_get_pixmap_uri().
+ *
+ * Returns: (transfer full): the pixmap, or %NULL if it could not be loaded.
+ *          Free with g_object_unref().
+ */
+GdkPixbuf *anaconda_widgets_load_pixmap(const gchar *name, gint height, GError **error) {
+    GdkPixbuf *pixbuf;
+    gchar *resource, *file;
+
+    resource = anaconda_widgets_get_pixmap_resource(name);
+    if (resource) {
+        pixbuf = gdk_pixbuf_new_from_resource_at_scale(resource, -1, height, FALSE, error);
+        g_free(resource);
+        return pixbuf;
+    }
+
+    file = g_strdup_printf("%s/pixmaps/%s", anaconda_get_widgets_datadir(), name);
+    pixbuf = gdk_pixbuf_new_from_file_at_scale(file, -1, height, FALSE, error);
+    g_free(file);
+    return pixbuf;
+}
+
+static void anaconda_icon_cache_theme_changed(GtkIconTheme *icon_theme, gpointer user_data) {
+    /* Anything already handed out stays valid, but new lookups start over */
+    g_hash_table_remove_all(icon_cache);
+}
+
+/**
+ * anaconda_widgets_get_icon:
+ * @icon_name: The name of the icon to look up in the icon theme.
+ * @emblem_file: (allow-none): The path or URI of an image to use as an emblem
+ *               on the icon, or %NULL for no emblem.
+ * @size: The size of the icon, in pixels.
+ * @scale: The scale factor of the window the icon will be displayed in.
+ *
+ * Look up and load an icon from the default icon theme.
+ *
+ * Icons are cached for the life of the process, so every widget asking for
+ * the same icon name, emblem, size and scale shares one #GdkPixbuf and the
+ * icon theme is only consulted once. The cache is dropped when the icon
+ * theme changes.
+ *
+ * Returns: (transfer full): the icon, or %NULL if it could not be loaded.
+ *          Free with g_object_unref().
+ */
+GdkPixbuf *anaconda_widgets_get_icon(const gchar *icon_name, const gchar *emblem_file, gint size, gint scale) {
+    GError *err = NULL;
+    GIcon *base_icon, *emblem_icon, *icon;
+    GEmblem *emblem;
+
+    GtkIconTheme *icon_theme;
+    GtkIconInfo *icon_info;
+    GdkPixbuf *pixbuf;
+    gchar *key;
+
+    g_return_val_if_fail(icon_name != NULL, NULL);
+
+    icon_theme = gtk_icon_theme_get_default();
+
+    if (!icon_cache) {
+        icon_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+        g_signal_connect(icon_theme, "changed", G_CALLBACK(anaconda_icon_cache_theme_changed), NULL);
+    }
+
+    key = g_strdup_printf("%s\n%s\n%d\n%d", icon_name, emblem_file ? emblem_file : "", size, scale);
+    pixbuf = g_hash_table_lookup(icon_cache, key);
+    if (pixbuf) {
+        g_free(key);
+        return g_object_ref(pixbuf);
+    }
+
+    icon = g_icon_new_for_string(icon_name, &err);
+    if (!icon) {
+        fprintf(stderr, "could not create icon: %s\n", err->message);
+        g_error_free(err);
+        g_free(key);
+        return NULL;
+    }
+
+    if (emblem_file) {
+        emblem_icon = g_icon_new_for_string(emblem_file, &err);
+        if (!emblem_icon) {
+            fprintf(stderr, "could not create emblem: %s\n", err->message);
+            g_error_free(err);
+        } else {
+            emblem = g_emblem_new(emblem_icon);
+            g_object_unref(emblem_icon);
+
+            base_icon = icon;
+            icon = g_emblemed_icon_new(base_icon, emblem);
+            g_object_unref(base_icon);
+            g_object_unref(emblem);
+        }
+    }
+
+    icon_info = gtk_icon_theme_lookup_by_gicon_for_scale(icon_theme, icon, size, scale, 0);
+    g_object_unref(icon);
+    if (!icon_info) {
+        fprintf(stderr, "could not find icon: %s\n", icon_name);
+        g_free(key);
+        return NULL;
+    }
+
+    pixbuf = gtk_icon_info_load_icon(icon_info, &err);
+    g_object_unref(icon_info);
+    if (!pixbuf) {
+        fprintf(stderr, "could not load icon: %s\n", err->message);
+        g_error_free(err);
+        g_free(key);
+        return NULL;
+    }
+
+    /* The cache keeps its own reference */
+    g_hash_table_insert(icon_cache, key, g_object_ref(pixbuf));
+    return pixbuf;
+}
+
+/**
+ * anaconda_widgets_set_image_icon:
+ * @image: The image to display the icon in.
+ * @icon_name: The name of the icon to look up in the icon theme.
+ * @emblem_file: (allow-none): The path or URI of an image to use as an emblem
+ *               on the icon, or %NULL for no emblem.
+ * @size: The size of the icon, in application pixels.
+ *
+ * Display an icon from anaconda_widgets_get_icon() in @image at the scale
+ * factor of @image.  The icon is loaded @size pixels times the scale factor
+ * large and handed to @image as a surface of that scale, so it takes up
+ * @size application pixels either way.
+ *
+ * The scale factor of a widget is only known once it is in a window, so
+ * callers should call this again when #GtkWidget:scale-factor changes.
+ *
+ * Returns: %TRUE if the icon was loaded.  If not, @image is left as it was.
+ */
+gboolean anaconda_widgets_set_image_icon(GtkImage *image, const gchar *icon_name, const gchar *emblem_file, gint size) {
+    GdkPixbuf *pixbuf;
+    cairo_surface_t *surface;
+    gint scale;
+
+    g_return_val_if_fail(GTK_IS_IMAGE(image), FALSE);
+
+    scale = gtk_widget_get_scale_factor(GTK_WIDGET(image));
+    pixbuf = anaconda_widgets_get_icon(icon_name, emblem_file, size, scale);
+    if (!pixbuf)
+        return FALSE;
+
+    surface = gdk_cairo_surface_create_from_pixbuf(pixbuf, scale, NULL);
+    gtk_image_set_from_surface(image, surface);
+    cairo_surface_destroy(surface);
+    g_object_unref(pixbuf);
+    return TRUE;
+}
@@ -21,10 +21,16 @@
 #define _WIDGETS_COMMON_H
 
 #include <glib.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gtk/gtk.h>
 
 G_BEGIN_DECLS
 
 const gchar *anaconda_get_widgets_datadir(void);
+gchar *anaconda_widgets_get_pixmap_uri(const gchar *name);
+GdkPixbuf *anaconda_widgets_load_pixmap(const gchar *name, gint height, GError **error);
+GdkPixbuf *anaconda_widgets_get_icon(const gchar *icon_name, const gchar *emblem_file, gint size, gint scale);
+gboolean anaconda_widgets_set_image_icon(GtkImage *image, const gchar *icon_name, const gchar *emblem_file, gint size);
 
 G_END_DECLS
 